@@ -0,0 +1,57 @@
+#include "benchTiming.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+double medianMs(const std::function<void()>& run, int iterations) {
+	std::vector<double> times;
+	for (int i = 0; i < iterations; ++i) {
+		const auto start = std::chrono::steady_clock::now();
+		run();
+		times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+	return times[times.size() / 2];
+}
+
+BenchTable::BenchTable(std::ostream& out, const std::vector<Column>& columns, int precision)
+	: out_(out),
+	columns_(columns),
+	precision_(precision) {
+
+	for (const auto& column : columns_) {
+		cell(column.name);
+	}
+	endRow();
+}
+
+BenchTable& BenchTable::cell(const std::string& text) {
+	if (column_ < columns_.size()) {
+		const int width = columns_[column_].width;
+		if (column_ == 0) {
+			out_ << std::left << std::setw(width) << text << std::right;
+		}
+		else {
+			out_ << std::setw(width) << text;
+		}
+		++column_;
+	}
+	return *this;
+}
+
+BenchTable& BenchTable::cell(double value) {
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(precision_) << value;
+	return cell(text.str());
+}
+
+BenchTable& BenchTable::cell(int value) {
+	return cell(std::to_string(value));
+}
+
+void BenchTable::endRow() {
+	out_ << "\n";
+	column_ = 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* Timing and table output shared by the benchmark tools. */
+
+// Runs run() iterations times and returns the median wall time in milliseconds
+double medianMs(const std::function<void()>& run, int iterations);
+
+// Fixed width console table. The first column is left aligned, the others right aligned, and
+// numbers are printed with a fixed number of decimals without touching the stream's flags.
+class BenchTable {
+public:
+	struct Column {
+		std::string name;
+		int width;
+	};
+
+	// Prints the header row
+	BenchTable(std::ostream& out, const std::vector<Column>& columns, int precision = 2);
+
+	BenchTable& cell(const std::string& text);
+	BenchTable& cell(double value);
+	BenchTable& cell(int value);
+
+	// Ends the current row; columns without a cell are left blank
+	void endRow();
+
+private:
+	std::ostream& out_;
+	std::vector<Column> columns_;
+	int precision_;
+	size_t column_ = 0;
+};
@@ -4,6 +4,24 @@
 #include <vector>
 #include <iomanip> // For std::setfill and std::setw
 #include <iostream>
+#include <chrono> // For wall time measurements
+#include <future> // For std::async
+#include <fstream> // For restoring calibration files after a comparison
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+#include "calibrationIO.h"
+#include "stereoRectifier.h"
+#include "chessboardDetector.h"
+#include "cornerShards.h"
+
+// Reprojection errors and wall time of one calibration run, used to compare flows
+struct CalibrationSummary {
+	double errorLeft = -1.0;
+	double errorRight = -1.0;
+	double stereoError = -1.0;
+	double seconds = 0.0;
+};
 
 static int displayCheckerBoardPattern() {
 	// Setup OpenCV Windows, make them resizable
@@ -11,6 +29,7 @@ static int displayCheckerBoardPattern() {
 	cv::namedWindow("Right", cv::WINDOW_NORMAL);
 
 	const cv::Size patternSize(10, 5); // Number of internal corners per a chessboard row and column
+	ChessboardDetector detector(patternSize);
 
 	// Storage for detected corners for later calibration
 	std::vector<std::vector<cv::Point2f>> allCornersLeft;
@@ -50,16 +69,9 @@ static int displayCheckerBoardPattern() {
 
 		// --- Detect Checkerboard in Left Image ---
 		std::vector<cv::Point2f> cornersL;
-		bool foundL = cv::findChessboardCorners(imageL, patternSize, cornersL);
+		bool foundL = detector.detect(imageL, cornersL);
 
 		if (foundL) {
-			// Optional: refine corners
-			/*cv::Mat grayL;
-			cv::cvtColor(imageL, grayL, cv::COLOR_BGR2GRAY);
-			cv::cornerSubPix(
-				grayL, cornersL, cv::Size(11, 11), cv::Size(-1, -1),
-				cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.001)
-			);*/
 			// Draw detected corners
 			cv::drawChessboardCorners(imageL, patternSize, cornersL, foundL);
 			allCornersLeft.push_back(cornersL);
@@ -72,17 +84,9 @@ static int displayCheckerBoardPattern() {
 
 		// ----- Detect Checkerboard corners in Right Image ----
 		std::vector<cv::Point2f> cornersR;
-		bool foundR = cv::findChessboardCorners(imageR, patternSize, cornersR);
+		bool foundR = detector.detect(imageR, cornersR);
 
 		if (foundR) {
-			// Refine the corner locations for calibration
-			/*
-			cv::Mat greyR;
-			cv::cvtColor(imageR, greyR, cv::COLOR_BGR2GRAY);
-			cv::cornerSubPix(greyR, cornersR, cv::Size(11, 11),
-			cv::Size(-1, -1), cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.001));
-			*/
-
 			// Draw the corners on the image
 			cv::drawChessboardCorners(imageR, patternSize, cornersR, foundR);
 
@@ -108,6 +112,7 @@ static int displayCheckerBoardPattern() {
 
 	std::cout << "Finished displaying all calibration images.\n";
 	std::cout << "Total images processed: " << allCornersLeft.size() + allCornersRight.size() << std::endl;
+	detector.printStats(std::cout);
 	if (allCornersLeft.size() != allCornersRight.size()) {
 		std::cerr << "Warning: Number of detected corners in left and right images do not match!" << std::endl;
 
@@ -162,14 +167,12 @@ static int undistortImage(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs
 	return 0;
 }
 
-static int calibrateBothSets() {
-	// --- debugging flag ---
-	const bool useGrayscalePreprocessing = true;
-
+static int calibrateBothSets(CalibrationSummary* summary = nullptr) {
 	// --- Setup calibration pattern info ---
 	const cv::Size patternSize(10, 5); // 10 internal corners wide, 5 tall
 	const float squareSize = 47.0f;    // 47mm per square
 	const cv::Size imageSize(1920, 1080); // Image size (in pixels)
+	ChessboardDetector detector(patternSize); // Detects on grayscale and refines corners
 
 	// --- Storage for all detections ---
 	std::vector<std::vector<cv::Point3f>> objectPointsLeft, objectPointsRight; // 3D points in world space
@@ -209,44 +212,13 @@ static int calibrateBothSets() {
 			continue;
 		}
 
-		// --- Prepare images for detection ---
-		cv::Mat detectImageL = imageL;
-		cv::Mat detectImageR = imageR;
-		int flags = 0;
-
-		if (useGrayscalePreprocessing) {
-			cv::cvtColor(imageL, detectImageL, cv::COLOR_BGR2GRAY);
-			cv::cvtColor(imageR, detectImageR, cv::COLOR_BGR2GRAY);
-			flags = cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE | cv::CALIB_CB_FAST_CHECK;
-		}
-
 		// --- Detect corners in Both Images ---
 		std::vector<cv::Point2f> cornersL, cornersR;
-		bool foundL = cv::findChessboardCorners(detectImageL, patternSize, cornersL, flags);
-		bool foundR = cv::findChessboardCorners(detectImageR, patternSize, cornersR, flags);
+		bool foundL = detector.detect(imageL, cornersL);
+		bool foundR = detector.detect(imageR, cornersR);
 
 		// Only save if **both** detections succeed
 		if (foundL && foundR) {
-			// Optional refinement (always done on grayscale)
-			cv::Mat grayL, grayR;
-			if (!useGrayscalePreprocessing) {
-				cv::cvtColor(imageL, grayL, cv::COLOR_BGR2GRAY);
-				cv::cvtColor(imageR, grayR, cv::COLOR_BGR2GRAY);
-			}
-			else {
-				grayL = detectImageL;
-				grayR = detectImageR;
-			}
-
-			cv::cornerSubPix(
-				grayL, cornersL, cv::Size(11, 11), cv::Size(-1, -1),
-				cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.001)
-			);
-			cv::cornerSubPix(
-				grayR, cornersR, cv::Size(11, 11), cv::Size(-1, -1),
-				cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.001)
-			);
-
 			imagePointsLeft.push_back(cornersL);
 			objectPointsLeft.push_back(checkerboardPattern);
 
@@ -258,6 +230,8 @@ static int calibrateBothSets() {
 		}
 	}
 
+	detector.printStats(std::cout);
+
 	// --- Now calibrate Left Camera ---
 	if (imagePointsLeft.empty()) {
 		std::cerr << "No valid detections for Left camera. Calibration failed!" << std::endl;
@@ -310,6 +284,11 @@ static int calibrateBothSets() {
 	std::cout << "Camera Matrix (K):\n" << cameraMatrixRight << "\n";
 	std::cout << "Distortion Coefficients:\n" << distCoeffsRight << "\n";
 
+	if (summary) {
+		summary->errorLeft = reprojectionErrorLeft;
+		summary->errorRight = reprojectionErrorRight;
+	}
+
 	return 0;
 }
 
@@ -357,13 +336,17 @@ static int testStereoDifference() {
 	return 0;
 }
 
-static int stereoCalibratePair() {
+static int stereoCalibratePair(CalibrationSummary* summary = nullptr) {
 	// ----- Setup calibration pattern info -----
 	const cv::Size patternSize(10, 5); // Checkerboard internal corners
 	const float squareSize = 47.0f;    // Square size in mm
 	const cv::Size imageSize(1920, 1080); // Calibration image size
 	const bool refineCorners = false; // Refine corner locations
 
+	ChessboardDetectorOptions detectorOptions;
+	detectorOptions.refineCorners = refineCorners;
+	ChessboardDetector detector(patternSize, detectorOptions);
+
 	// ----- Load the camera matrices and distortion coefficients -----
 	// Load the left camera calibration data
 	cv::Mat cameraMatrixLeft, distCoeffsLeft;
@@ -433,25 +416,13 @@ static int stereoCalibratePair() {
 			continue;
 		}
 
-		//Find Corners
+		//Find Corners (refinement is handled by the detector)
 		std::vector<cv::Point2f> cornersL, cornersR;
-		bool foundL = cv::findChessboardCorners(imageL, patternSize, cornersL);
-		bool foundR = cv::findChessboardCorners(imageR, patternSize, cornersR);
+		bool foundL = detector.detect(imageL, cornersL);
+		bool foundR = detector.detect(imageR, cornersR);
 
 		// Only save if **both** detections succeed
 		if (foundL && foundR) {
-			// Refine corners optional
-			if (refineCorners) {
-				cv::Mat grayL, grayR;
-				cv::cvtColor(imageL, grayL, cv::COLOR_BGR2GRAY);
-				cv::cvtColor(imageR, grayR, cv::COLOR_BGR2GRAY);
-				cv::cornerSubPix(grayL, cornersL, cv::Size(11, 11), cv::Size(-1, -1),
-					cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.001));
-				cv::cornerSubPix(grayR, cornersR, cv::Size(11, 11), cv::Size(-1, -1),
-					cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.001));
-			}
-
-			// Draw detected corners
 			imagePointsLeft.push_back(cornersL);
 			imagePointsRight.push_back(cornersR);
 			objectPoints.push_back(checkerboardPattern);
@@ -463,6 +434,7 @@ static int stereoCalibratePair() {
 	}
 
 	std::cout << "Total valid stereo pairs: " << validPairs << "\n";
+	detector.printStats(std::cout);
 
 	// --- Check if there are enough valid detections ---
 	if (objectPoints.size() < 5) { // Arbitrary low threshold
@@ -514,6 +486,331 @@ static int stereoCalibratePair() {
 	std::cout << "Rotation Matrix (R):\n" << R << "\n";
 	std::cout << "Translation Vector (T):\n" << T << "\n";
 
+	if (summary) {
+		summary->stereoError = stereoError;
+	}
+
+	return 0;
+}
+
+// Calibration image pairs, in the order their corners are fed to the solvers
+static std::vector<StereoPairJob> calibrationPairJobs() {
+	std::vector<StereoPairJob> jobs;
+	for (int i = 457; i < 476; ++i) {
+		std::ostringstream pathStreamL;
+		pathStreamL << "data/CalibrationLeft/DSCF"
+			<< std::setfill('0') << std::setw(4) << i
+			<< "_L.JPG";
+		std::ostringstream pathStreamR;
+		pathStreamR << "data/CalibrationRight/DSCF"
+			<< std::setfill('0') << std::setw(4) << i
+			<< "_R.JPG";
+		jobs.push_back({ i, pathStreamL.str(), pathStreamR.str() });
+	}
+	return jobs;
+}
+
+/* Solves both intrinsic calibrations concurrently on the same detections, then seeds
+ * stereoCalibrate with them, either held fixed (fixIntrinsics = true) or refined together
+ * with R and T. pairCorners must be in pair list order and detected with detectedPatternSize,
+ * which has to match the board modelled here.
+ * Writes the same YAML files as calibrateBothSets() and stereoCalibratePair(), plus the
+ * combined stereo_camera_calibration.yml read by the stereo tool.
+ */
+static int solveStereoCalibration(const std::vector<PairCorners>& pairCorners, const cv::Size& detectedPatternSize,
+	bool fixIntrinsics, CalibrationSummary* summary = nullptr) {
+	// --- Setup calibration pattern info ---
+	const cv::Size patternSize(10, 5); // 10 internal corners wide, 5 tall
+	const float squareSize = 47.0f;    // 47mm per square
+	const cv::Size imageSize(1920, 1080); // Image size (in pixels)
+
+	// Same corner count is not enough, a 5x10 detection would give transposed object points
+	if (detectedPatternSize != patternSize) {
+		std::cerr << "Corners were detected for a " << detectedPatternSize.width << "x" << detectedPatternSize.height
+			<< " pattern, expected " << patternSize.width << "x" << patternSize.height << "\n";
+		return -1;
+	}
+
+	// --- Build the checkerboard model points (real-world 3D) ---
+	std::vector<cv::Point3f> checkerboardPattern;
+	for (int y = 0; y < patternSize.height; ++y) {
+		for (int x = 0; x < patternSize.width; ++x) {
+			checkerboardPattern.push_back(cv::Point3f(x * squareSize, y * squareSize, 0.0f));
+		}
+	}
+
+	std::vector<std::vector<cv::Point3f>> objectPoints;
+	std::vector<std::vector<cv::Point2f>> imagePointsLeft, imagePointsRight;
+	for (const auto& pair : pairCorners) {
+		if (!pair.found) {
+			std::cout << "Checkerboard detection failed for pair: " << pair.index << std::endl;
+			continue;
+		}
+		if (static_cast<int>(pair.left.size()) != patternSize.area() ||
+			static_cast<int>(pair.right.size()) != patternSize.area()) {
+			std::cerr << "Pair " << pair.index << " was detected with a different pattern size\n";
+			return -1;
+		}
+		imagePointsLeft.push_back(pair.left);
+		imagePointsRight.push_back(pair.right);
+		objectPoints.push_back(checkerboardPattern);
+	}
+
+	std::cout << "Total valid stereo pairs: " << objectPoints.size() << "\n";
+	if (objectPoints.size() < 5) { // Same threshold as stereoCalibratePair()
+		std::cerr << "Not enough valid checkerboard detections for reliable stereo calibration.\n";
+		return -1;
+	}
+
+	// --- Solve both intrinsic calibrations concurrently on the same detections ---
+	cv::Mat cameraMatrixLeft, distCoeffsLeft;
+	cv::Mat cameraMatrixRight, distCoeffsRight;
+
+	std::future<double> leftSolve = std::async(std::launch::async, [&]() {
+		std::vector<cv::Mat> rvecs, tvecs;
+		return cv::calibrateCamera(objectPoints, imagePointsLeft, imageSize,
+			cameraMatrixLeft, distCoeffsLeft, rvecs, tvecs);
+	});
+
+	std::vector<cv::Mat> rvecsRight, tvecsRight;
+	double reprojectionErrorRight = cv::calibrateCamera(objectPoints, imagePointsRight, imageSize,
+		cameraMatrixRight, distCoeffsRight, rvecsRight, tvecsRight);
+	double reprojectionErrorLeft = leftSolve.get();
+
+	// --- Stereo calibration, warm started from the intrinsics above ---
+	cv::Mat R, T, E, F;
+	const int stereoFlags = fixIntrinsics ? cv::CALIB_FIX_INTRINSIC : cv::CALIB_USE_INTRINSIC_GUESS;
+
+	double stereoError = cv::stereoCalibrate(
+		objectPoints,
+		imagePointsLeft,
+		imagePointsRight,
+		cameraMatrixLeft,
+		distCoeffsLeft,
+		cameraMatrixRight,
+		distCoeffsRight,
+		imageSize,
+		R, T, E, F,
+		stereoFlags
+	);
+
+	// --- Save Results ---
+	cv::FileStorage fsLeft("left_camera_calibration.yml", cv::FileStorage::WRITE);
+	fsLeft << "CameraMatrix" << cameraMatrixLeft;
+	fsLeft << "DistCoeffs" << distCoeffsLeft;
+	fsLeft.release();
+
+	cv::FileStorage fsRight("right_camera_calibration.yml", cv::FileStorage::WRITE);
+	fsRight << "CameraMatrix" << cameraMatrixRight;
+	fsRight << "DistCoeffs" << distCoeffsRight;
+	fsRight.release();
+
+	cv::FileStorage fs("stereo_calibration.yml", cv::FileStorage::WRITE);
+	if (!fs.isOpened()) {
+		std::cerr << "Error: Could not open stereo_calibration.yml for writing\n";
+		return -1;
+	}
+	fs << "RotationMatrix" << R;
+	fs << "TranslationVector" << T;
+	fs << "EssentialMatrix" << E;
+	fs << "FundamentalMatrix" << F;
+	fs.release();
+
+	saveStereoCalibration("stereo_camera_calibration.yml",
+		cameraMatrixLeft, distCoeffsLeft,
+		cameraMatrixRight, distCoeffsRight,
+		R, T);
+
+	// --- Print Results ---
+	std::cout << "\n=== Joint Stereo Calibration (" << (fixIntrinsics ? "fixed" : "refined") << " intrinsics) ===\n";
+	std::cout << "Left Reprojection Error = " << reprojectionErrorLeft << " pixels\n";
+	std::cout << "Right Reprojection Error = " << reprojectionErrorRight << " pixels\n";
+	std::cout << "Stereo Reprojection Error = " << stereoError << " pixels\n";
+	std::cout << "Left Camera Matrix:\n" << cameraMatrixLeft << "\n";
+	std::cout << "Right Camera Matrix:\n" << cameraMatrixRight << "\n";
+	std::cout << "Rotation Matrix (R):\n" << R << "\n";
+	std::cout << "Translation Vector (T):\n" << T << "\n";
+
+	if (summary) {
+		summary->errorLeft = reprojectionErrorLeft;
+		summary->errorRight = reprojectionErrorRight;
+		summary->stereoError = stereoError;
+	}
+
+	return 0;
+}
+
+/* Single calibration stage for the stereo rig.
+ * Corners are detected once for every pair (in parallel, with sub-pixel refinement) and
+ * handed to solveStereoCalibration().
+ */
+static int calibrateStereoJoint(bool fixIntrinsics, CalibrationSummary* summary = nullptr) {
+	const auto startTime = std::chrono::steady_clock::now();
+
+	const cv::Size patternSize(10, 5); // 10 internal corners wide, 5 tall
+	ChessboardDetector detector(patternSize); // Shared by all detection threads
+
+	std::vector<PairCorners> pairCorners = detectPairCorners(calibrationPairJobs(), detector);
+	detector.printStats(std::cout);
+
+	if (solveStereoCalibration(pairCorners, detector.patternSize(), fixIntrinsics, summary) != 0) {
+		return -1;
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "Wall time = " << seconds << " s\n";
+	if (summary) {
+		summary->seconds = seconds;
+	}
+
+	return 0;
+}
+
+/* Detection half of the joint stage for one shard of the pair list (spec "i/N").
+ * Run one process per shard, on one machine or several, then combine the corner files with
+ * calibrateFromCornerShards().
+ */
+static int detectCornerShard(const std::string& shardSpec, const std::string& outputFile) {
+	int shardIndex = 0, shardCount = 1;
+	if (!parseShardSpec(shardSpec, shardIndex, shardCount)) {
+		std::cerr << "Error: Invalid shard \"" << shardSpec << "\", expected i/N with 0 <= i < N\n";
+		return -1;
+	}
+
+	const cv::Size patternSize(10, 5); // 10 internal corners wide, 5 tall
+	ChessboardDetector detector(patternSize);
+
+	std::vector<StereoPairJob> jobs = shardSlice(calibrationPairJobs(), shardIndex, shardCount);
+	std::vector<PairCorners> pairCorners = detectPairCorners(jobs, detector);
+	writeCornerShard(outputFile, patternSize, shardIndex, shardCount, pairCorners);
+
+	int found = 0;
+	for (const auto& pair : pairCorners) {
+		found += pair.found ? 1 : 0;
+	}
+	std::cout << "Shard " << shardIndex << "/" << shardCount << ": " << found << " of " << jobs.size()
+		<< " pairs detected, written to " << outputFile << "\n";
+	detector.printStats(std::cout);
+
+	return 0;
+}
+
+// Merge step: combines the shard corner files and runs the solvers on them
+static int calibrateFromCornerShards(const std::vector<std::string>& shardFiles, bool fixIntrinsics) {
+	cv::Size patternSize;
+	std::vector<PairCorners> pairCorners;
+	if (!mergeCornerShards(shardFiles, patternSize, pairCorners)) {
+		std::cerr << "Could not merge corner shards.\n";
+		return -1;
+	}
+	std::cout << "Merged " << shardFiles.size() << " shards, " << pairCorners.size() << " pairs\n";
+
+	return solveStereoCalibration(pairCorners, patternSize, fixIntrinsics);
+}
+
+// Contents of the calibration files a run overwrites, so a comparison can put them back
+struct CalibrationFileSnapshot {
+	std::string path;
+	bool existed = false;
+	std::string contents;
+};
+
+static std::vector<CalibrationFileSnapshot> snapshotCalibrationFiles() {
+	const char* paths[] = { "left_camera_calibration.yml", "right_camera_calibration.yml",
+		"stereo_calibration.yml", "stereo_camera_calibration.yml" };
+
+	std::vector<CalibrationFileSnapshot> snapshots;
+	for (const char* path : paths) {
+		CalibrationFileSnapshot snapshot;
+		snapshot.path = path;
+		std::ifstream file(path, std::ios::binary);
+		if (file) {
+			std::ostringstream contents;
+			contents << file.rdbuf();
+			snapshot.existed = true;
+			snapshot.contents = contents.str();
+		}
+		snapshots.push_back(snapshot);
+	}
+	return snapshots;
+}
+
+static void restoreCalibrationFiles(const std::vector<CalibrationFileSnapshot>& snapshots) {
+	for (const auto& snapshot : snapshots) {
+		if (snapshot.existed) {
+			std::ofstream file(snapshot.path, std::ios::binary | std::ios::trunc);
+			file << snapshot.contents;
+		}
+		else {
+			std::remove(snapshot.path.c_str());
+		}
+	}
+}
+
+/* Runs the original three step flow (calibrateBothSets, YAML round trip, stereoCalibratePair)
+ * and the joint stage with fixed and refined intrinsics, then prints wall time and
+ * reprojection errors side by side.
+ * Every flow is timed over the same span, from the first image read to its last YAML write.
+ * Each runs once untimed to warm the file cache and thread pool, then the timed rounds
+ * rotate the order and the median is reported. The calibration files are restored afterwards.
+ */
+static int compareCalibrationFlows() {
+	const int timedRounds = 3;
+
+	struct Flow {
+		std::string name;
+		std::function<int(CalibrationSummary*)> run;
+		CalibrationSummary summary;
+		std::vector<double> seconds;
+	};
+	std::vector<Flow> flows = {
+		{ "Three step", [](CalibrationSummary* s) {
+			return calibrateBothSets(s) != 0 || stereoCalibratePair(s) != 0 ? -1 : 0; }, {}, {} },
+		{ "Joint (fixed K)", [](CalibrationSummary* s) { return calibrateStereoJoint(true, s); }, {}, {} },
+		{ "Joint (refined K)", [](CalibrationSummary* s) { return calibrateStereoJoint(false, s); }, {}, {} },
+	};
+
+	const std::vector<CalibrationFileSnapshot> snapshots = snapshotCalibrationFiles();
+
+	for (int round = -1; round < timedRounds; ++round) {
+		for (size_t k = 0; k < flows.size(); ++k) {
+			// Round -1 is the untimed warm up, later rounds rotate which flow goes first
+			Flow& flow = flows[(k + std::max(round, 0)) % flows.size()];
+			const auto start = std::chrono::steady_clock::now();
+			if (flow.run(&flow.summary) != 0) {
+				std::cerr << flow.name << " calibration flow failed.\n";
+				restoreCalibrationFiles(snapshots);
+				return -1;
+			}
+			if (round >= 0) {
+				flow.seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+			}
+		}
+	}
+
+	restoreCalibrationFiles(snapshots);
+
+	auto printRow = [](const Flow& flow) {
+		std::vector<double> seconds = flow.seconds;
+		std::sort(seconds.begin(), seconds.end());
+		std::cout << std::left << std::setw(24) << flow.name << std::right << std::fixed << std::setprecision(4)
+			<< std::setw(10) << seconds[seconds.size() / 2]
+			<< std::setw(12) << flow.summary.errorLeft
+			<< std::setw(12) << flow.summary.errorRight
+			<< std::setw(12) << flow.summary.stereoError << "\n";
+	};
+
+	std::cout << "\n=== Calibration Flow Comparison (median of " << timedRounds << " runs) ===\n";
+	std::cout << std::left << std::setw(24) << "Flow" << std::right
+		<< std::setw(10) << "Time(s)"
+		<< std::setw(12) << "Left(px)"
+		<< std::setw(12) << "Right(px)"
+		<< std::setw(12) << "Stereo(px)" << "\n";
+	for (const auto& flow : flows) {
+		printRow(flow);
+	}
+	std::cout.unsetf(std::ios::floatfield);
+
 	return 0;
 }
 
@@ -558,25 +855,11 @@ static int stereoRectifyAndDisplay() {
 
 	const cv::Size imageSize(1920, 1080);
 
-	// --- Stereo Rectify ---
-	cv::Mat R1, R2, P1, P2, Q;
-	cv::Rect validRoi1, validRoi2;
-
-	cv::stereoRectify(
+	// --- Stereo Rectify and Create Rectification Maps ---
+	const StereoRectifier rectifier(
 		cameraMatrixLeft, distCoeffsLeft,
 		cameraMatrixRight, distCoeffsRight,
-		imageSize, R, T,
-		R1, R2, P1, P2, Q,
-		cv::CALIB_ZERO_DISPARITY, 1.0, imageSize, &validRoi1, &validRoi2
-	);
-
-	// --- Create Rectification Maps ---
-	cv::Mat mapLx, mapLy, mapRx, mapRy;
-	cv::initUndistortRectifyMap(
-		cameraMatrixLeft, distCoeffsLeft, R1, P1, imageSize, CV_32FC1, mapLx, mapLy
-	);
-	cv::initUndistortRectifyMap(
-		cameraMatrixRight, distCoeffsRight, R2, P2, imageSize, CV_32FC1, mapRx, mapRy
+		R, T, imageSize, 1.0, 1.0
 	);
 
 	// --- Pick a Random Image Index ---
@@ -607,8 +890,7 @@ static int stereoRectifyAndDisplay() {
 
 	// --- Apply Rectification ---
 	cv::Mat rectifiedL, rectifiedR;
-	cv::remap(imageL, rectifiedL, mapLx, mapLy, cv::INTER_LINEAR);
-	cv::remap(imageR, rectifiedR, mapRx, mapRy, cv::INTER_LINEAR);
+	rectifier.rectify(imageL, imageR, rectifiedL, rectifiedR);
 
 	// --- Display Results ---
 	cv::namedWindow("Original Left", cv::WINDOW_NORMAL);
@@ -647,10 +929,44 @@ static int stereoRectifyAndDisplay() {
 
 // Main function to run the processes
 int main(int argc, char* argv[]) {
+	// Command line parameters for sharded calibration
+	// Calibration detect --shard <i/N> --out <corners.yml>
+	// Calibration merge [--refine-intrinsics] <corners.yml>...
+	if (argc > 1 && std::string(argv[1]) == "detect") {
+		std::string shardSpec = "0/1";
+		std::string outputFile = "corners.yml";
+		if (argc % 2 != 0) {
+			std::cerr << "Usage: Calibration detect --shard <i/N> --out <corners.yml>\n";
+			return -1;
+		}
+		for (int a = 2; a + 1 < argc; a += 2) {
+			const std::string option = argv[a];
+			if (option == "--shard") shardSpec = argv[a + 1];
+			else if (option == "--out") outputFile = argv[a + 1];
+			else {
+				std::cerr << "Unknown option: " << option << "\n";
+				return -1;
+			}
+		}
+		return detectCornerShard(shardSpec, outputFile) == 0 ? 0 : 1;
+	}
+	if (argc > 1 && std::string(argv[1]) == "merge") {
+		bool fixIntrinsics = true;
+		std::vector<std::string> shardFiles;
+		for (int a = 2; a < argc; ++a) {
+			const std::string arg = argv[a];
+			if (arg == "--refine-intrinsics") fixIntrinsics = false;
+			else shardFiles.push_back(arg);
+		}
+		return calibrateFromCornerShards(shardFiles, fixIntrinsics) == 0 ? 0 : 1;
+	}
+
 	//testStereoDifference();
 	//displayCheckerBoardPattern();
 	//calibrateBothSets();
 	//stereoCalibratePair();
+	//calibrateStereoJoint(true);
+	//compareCalibrationFlows();
 	stereoRectifyAndDisplay();
 	return 0;
 }
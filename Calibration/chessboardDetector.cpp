@@ -0,0 +1,168 @@
+#include "chessboardDetector.h"
+
+#include <chrono>
+#include <iomanip>
+
+static double secondsSince(const std::chrono::steady_clock::time_point& start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void refineCorners(const cv::Mat& gray, std::vector<cv::Point2f>& corners) {
+	cv::cornerSubPix(gray, corners, cv::Size(11, 11), cv::Size(-1, -1),
+		cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.001));
+}
+
+const char* chessboardBackendName(ChessboardBackend backend) {
+	switch (backend) {
+	case ChessboardBackend::FastCheck: return "fast-check";
+	case ChessboardBackend::Classic: return "classic";
+	case ChessboardBackend::SectorBased: return "sector-based";
+	default: return "unknown";
+	}
+}
+
+ChessboardDetector::ChessboardDetector(const cv::Size& patternSize, const ChessboardDetectorOptions& options)
+	: patternSize_(patternSize),
+	options_(options) {
+	CV_Assert(options.fastScale > 0.0 && options.fastScale <= 1.0);
+}
+
+bool ChessboardDetector::detect(const cv::Mat& image, std::vector<cv::Point2f>& corners,
+	ChessboardBackend* backendUsed) {
+
+	cv::Mat gray = image;
+	if (image.channels() == 3) {
+		cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+	}
+
+	// --- Tier 1: fast check on a downscaled copy ---
+	// Downscaled corners only become accurate after refinement, so without refinement the fast
+	// pass runs at full resolution and its corners are returned as found
+	const double fastScale = options_.refineCorners ? options_.fastScale : 1.0;
+	auto start = std::chrono::steady_clock::now();
+	cv::Mat small = gray;
+	if (fastScale != 1.0) {
+		cv::resize(gray, small, cv::Size(), fastScale, fastScale, cv::INTER_AREA);
+	}
+
+	// checkChessboard is the test CALIB_CB_FAST_CHECK would run, done once here so its answer
+	// also separates "no board" from "inconclusive" when the detector misses
+	const bool boardPresent = cv::checkChessboard(small, patternSize_);
+	bool found = false;
+	if (boardPresent) {
+		found = cv::findChessboardCorners(small, patternSize_, corners,
+			cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE);
+	}
+	if (found && fastScale != 1.0) {
+		// Back to full resolution pixel centres, then refine against the full image
+		const float inverseScale = static_cast<float>(1.0 / fastScale);
+		for (auto& corner : corners) {
+			corner = (corner + cv::Point2f(0.5f, 0.5f)) * inverseScale - cv::Point2f(0.5f, 0.5f);
+		}
+		refineCorners(gray, corners);
+	}
+	else if (found && options_.refineCorners) {
+		refineCorners(gray, corners);
+	}
+	record(ChessboardBackend::FastCheck, found, secondsSince(start));
+
+	if (found) {
+		if (backendUsed) *backendUsed = ChessboardBackend::FastCheck;
+		return true;
+	}
+	if (!boardPresent && !options_.escalateOnReject) {
+		std::lock_guard<std::mutex> lock(statsMutex_);
+		++rejected_;
+		return false;
+	}
+
+	// --- Tier 2: classic detector at full resolution ---
+	// Skipped when the fast pass already ran it on the full resolution image
+	const bool classicTried = boardPresent && fastScale == 1.0;
+	if (options_.useClassic && !classicTried) {
+		start = std::chrono::steady_clock::now();
+		found = cv::findChessboardCorners(gray, patternSize_, corners,
+			cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE);
+		if (found && options_.refineCorners) {
+			refineCorners(gray, corners);
+		}
+		record(ChessboardBackend::Classic, found, secondsSince(start));
+
+		if (found) {
+			if (backendUsed) *backendUsed = ChessboardBackend::Classic;
+			return true;
+		}
+	}
+
+	// --- Tier 3: sector based detector, already sub-pixel accurate ---
+	if (options_.useSectorBased) {
+		start = std::chrono::steady_clock::now();
+		found = cv::findChessboardCornersSB(gray, patternSize_, corners,
+			cv::CALIB_CB_NORMALIZE_IMAGE | cv::CALIB_CB_EXHAUSTIVE | cv::CALIB_CB_ACCURACY);
+		record(ChessboardBackend::SectorBased, found, secondsSince(start));
+
+		if (found) {
+			if (backendUsed) *backendUsed = ChessboardBackend::SectorBased;
+			return true;
+		}
+	}
+
+	corners.clear();
+	return false;
+}
+
+void ChessboardDetector::record(ChessboardBackend backend, bool hit, double seconds) {
+	std::lock_guard<std::mutex> lock(statsMutex_);
+	ChessboardBackendStats& entry = stats_[static_cast<size_t>(backend)];
+	++entry.attempts;
+	if (hit) ++entry.hits;
+	entry.seconds += seconds;
+}
+
+ChessboardBackendStats ChessboardDetector::stats(ChessboardBackend backend) const {
+	std::lock_guard<std::mutex> lock(statsMutex_);
+	return stats_[static_cast<size_t>(backend)];
+}
+
+int ChessboardDetector::rejected() const {
+	std::lock_guard<std::mutex> lock(statsMutex_);
+	return rejected_;
+}
+
+void ChessboardDetector::resetStats() {
+	std::lock_guard<std::mutex> lock(statsMutex_);
+	stats_.fill(ChessboardBackendStats());
+	rejected_ = 0;
+}
+
+void ChessboardDetector::printStats(std::ostream& out) const {
+	std::lock_guard<std::mutex> lock(statsMutex_);
+
+	const std::ios::fmtflags oldFlags = out.flags();
+	const std::streamsize oldPrecision = out.precision();
+
+	out << "\n=== Chessboard Detector Stats ===\n";
+	out << std::left << std::setw(14) << "Backend" << std::right
+		<< std::setw(10) << "Attempts"
+		<< std::setw(8) << "Hits"
+		<< std::setw(10) << "Hit rate"
+		<< std::setw(12) << "Total(ms)"
+		<< std::setw(11) << "Mean(ms)" << "\n";
+
+	out << std::fixed << std::setprecision(1);
+	for (size_t i = 0; i < stats_.size(); ++i) {
+		const ChessboardBackendStats& entry = stats_[i];
+		const double hitRate = entry.attempts > 0 ? 100.0 * entry.hits / entry.attempts : 0.0;
+		const double meanMs = entry.attempts > 0 ? 1000.0 * entry.seconds / entry.attempts : 0.0;
+		out << std::left << std::setw(14) << chessboardBackendName(static_cast<ChessboardBackend>(i)) << std::right
+			<< std::setw(10) << entry.attempts
+			<< std::setw(8) << entry.hits
+			<< std::setw(9) << hitRate << "%"
+			<< std::setw(12) << 1000.0 * entry.seconds
+			<< std::setw(11) << meanMs << "\n";
+	}
+	out << "Rejected by fast check: " << rejected_ << "\n";
+
+	out.flags(oldFlags);
+	out.precision(oldPrecision);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Detection backends, in the order they are tried
+enum class ChessboardBackend {
+	FastCheck = 0,   // checkChessboard, then findChessboardCorners on a downscaled image
+	Classic = 1,     // full resolution findChessboardCorners without the fast check
+	SectorBased = 2, // findChessboardCornersSB
+	Count = 3
+};
+
+struct ChessboardBackendStats {
+	int attempts = 0;
+	int hits = 0;
+	double seconds = 0.0;
+};
+
+struct ChessboardDetectorOptions {
+	double fastScale = 0.5;        // Image scale used by the fast pass (1.0 when refineCorners is false)
+	bool useClassic = true;        // Escalate to the classic detector when the fast pass is inconclusive
+	bool useSectorBased = true;    // Escalate to findChessboardCornersSB if the classic detector also fails
+	bool escalateOnReject = false; // Escalate even when the fast pass finds no board at all
+	bool refineCorners = true;     // cornerSubPix the fast pass and classic corners. When false the fast
+	                               // pass runs at full resolution, since downscaled corners need refining
+};
+
+/* Tiered chessboard detector shared by every calibration stage.
+ * Each image first goes through a cheap fast-check pass on a downscaled grayscale copy. If that
+ * finds the board, the corners are scaled back up and refined at full resolution. If the
+ * fast check says there is no board (cv::checkChessboard fails), the image is rejected
+ * straight away, since that is where the classic detector spends most of its time. Only the
+ * inconclusive case (board-like structure but no detection) escalates to the classic detector
+ * and then findChessboardCornersSB. When the fast pass already ran at full resolution the classic
+ * tier would repeat it exactly, so it is skipped.
+ *
+ * Per backend attempts, hits and time are recorded so the tiers can be tuned to the data.
+ * detect() may be called from several threads at once.
+ */
+class ChessboardDetector {
+public:
+	explicit ChessboardDetector(const cv::Size& patternSize,
+		const ChessboardDetectorOptions& options = ChessboardDetectorOptions());
+
+	// Accepts grayscale or BGR images. Returns true and fills corners on success.
+	bool detect(const cv::Mat& image, std::vector<cv::Point2f>& corners,
+		ChessboardBackend* backendUsed = nullptr);
+
+	ChessboardBackendStats stats(ChessboardBackend backend) const;
+	int rejected() const;
+	void resetStats();
+	void printStats(std::ostream& out) const;
+
+	const cv::Size& patternSize() const { return patternSize_; }
+
+private:
+	void record(ChessboardBackend backend, bool hit, double seconds);
+
+	cv::Size patternSize_;
+	ChessboardDetectorOptions options_;
+
+	mutable std::mutex statsMutex_;
+	std::array<ChessboardBackendStats, static_cast<size_t>(ChessboardBackend::Count)> stats_;
+	int rejected_ = 0; // Images the fast pass ruled out without escalating
+};
+
+const char* chessboardBackendName(ChessboardBackend backend);
@@ -0,0 +1,185 @@
+#include "cornerShards.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+bool parseShardSpec(const std::string& spec, int& shardIndex, int& shardCount) {
+	std::istringstream stream(spec);
+	char slash = 0;
+	if (!(stream >> shardIndex >> slash >> shardCount) || slash != '/' || !stream.eof()) {
+		return false;
+	}
+	return shardCount > 0 && shardIndex >= 0 && shardIndex < shardCount;
+}
+
+std::vector<StereoPairJob> shardSlice(const std::vector<StereoPairJob>& jobs, int shardIndex, int shardCount) {
+	CV_Assert(shardCount > 0 && shardIndex >= 0 && shardIndex < shardCount);
+
+	// Spread the remainder over the first shards so slice sizes differ by at most one
+	const size_t base = jobs.size() / shardCount;
+	const size_t remainder = jobs.size() % shardCount;
+	const size_t begin = shardIndex * base + std::min<size_t>(shardIndex, remainder);
+	const size_t end = begin + base + (static_cast<size_t>(shardIndex) < remainder ? 1 : 0);
+
+	return std::vector<StereoPairJob>(jobs.begin() + begin, jobs.begin() + end);
+}
+
+std::vector<PairCorners> detectPairCorners(const std::vector<StereoPairJob>& jobs, ChessboardDetector& detector) {
+	std::vector<PairCorners> results(jobs.size());
+
+	cv::parallel_for_(cv::Range(0, static_cast<int>(jobs.size())), [&](const cv::Range& range) {
+		for (int k = range.start; k < range.end; ++k) {
+			PairCorners& result = results[k];
+			result.index = jobs[k].index;
+
+			// Detection only needs grayscale, so decode straight to it
+			cv::Mat grayL = cv::imread(jobs[k].leftPath, cv::IMREAD_GRAYSCALE);
+			cv::Mat grayR = cv::imread(jobs[k].rightPath, cv::IMREAD_GRAYSCALE);
+			if (grayL.empty() || grayR.empty()) {
+				continue;
+			}
+
+			result.found = detector.detect(grayL, result.left) && detector.detect(grayR, result.right);
+			if (!result.found) {
+				result.left.clear();
+				result.right.clear();
+			}
+		}
+	});
+
+	return results;
+}
+
+void writeCornerShard(const std::string& filename, const cv::Size& patternSize,
+	int shardIndex, int shardCount, const std::vector<PairCorners>& results) {
+
+	const int cornerCount = patternSize.area();
+
+	// One row per pair: pair index and found flag, plus a row of corners per camera
+	cv::Mat indices(static_cast<int>(results.size()), 2, CV_32S);
+	cv::Mat cornersLeft = cv::Mat::zeros(static_cast<int>(results.size()), cornerCount, CV_32FC2);
+	cv::Mat cornersRight = cv::Mat::zeros(static_cast<int>(results.size()), cornerCount, CV_32FC2);
+
+	for (int k = 0; k < static_cast<int>(results.size()); ++k) {
+		const PairCorners& result = results[k];
+		indices.at<int>(k, 0) = result.index;
+		indices.at<int>(k, 1) = result.found ? 1 : 0;
+		if (result.found) {
+			CV_Assert(static_cast<int>(result.left.size()) == cornerCount && static_cast<int>(result.right.size()) == cornerCount);
+			std::copy(result.left.begin(), result.left.end(), cornersLeft.ptr<cv::Point2f>(k));
+			std::copy(result.right.begin(), result.right.end(), cornersRight.ptr<cv::Point2f>(k));
+		}
+	}
+
+	cv::FileStorage fs(filename, cv::FileStorage::WRITE | cv::FileStorage::BASE64);
+	if (!fs.isOpened()) {
+		CV_Error(cv::Error::StsError, "Could not open " + filename + " for writing");
+	}
+	fs << "PatternWidth" << patternSize.width;
+	fs << "PatternHeight" << patternSize.height;
+	fs << "ShardIndex" << shardIndex;
+	fs << "ShardCount" << shardCount;
+	fs << "Pairs" << indices;
+	fs << "CornersLeft" << cornersLeft;
+	fs << "CornersRight" << cornersRight;
+	fs.release();
+}
+
+bool readCornerShard(const std::string& filename, cv::Size& patternSize,
+	int& shardIndex, int& shardCount, std::vector<PairCorners>& results) {
+
+	cv::FileStorage fs(filename, cv::FileStorage::READ);
+	if (!fs.isOpened()) {
+		std::cerr << "Error: Could not open corner shard " << filename << "\n";
+		return false;
+	}
+
+	cv::Mat indices, cornersLeft, cornersRight;
+	fs["PatternWidth"] >> patternSize.width;
+	fs["PatternHeight"] >> patternSize.height;
+	fs["ShardIndex"] >> shardIndex;
+	fs["ShardCount"] >> shardCount;
+	fs["Pairs"] >> indices;
+	fs["CornersLeft"] >> cornersLeft;
+	fs["CornersRight"] >> cornersRight;
+	fs.release();
+
+	results.clear();
+	if (indices.empty()) {
+		return true; // A shard can legitimately have no pairs
+	}
+	if (cornersLeft.rows != indices.rows || cornersRight.rows != indices.rows ||
+		cornersLeft.cols != patternSize.area() || cornersRight.cols != patternSize.area()) {
+		std::cerr << "Error: Corner shard " << filename << " is malformed\n";
+		return false;
+	}
+
+	for (int k = 0; k < indices.rows; ++k) {
+		PairCorners result;
+		result.index = indices.at<int>(k, 0);
+		result.found = indices.at<int>(k, 1) != 0;
+		if (result.found) {
+			const cv::Point2f* rowLeft = cornersLeft.ptr<cv::Point2f>(k);
+			const cv::Point2f* rowRight = cornersRight.ptr<cv::Point2f>(k);
+			result.left.assign(rowLeft, rowLeft + cornersLeft.cols);
+			result.right.assign(rowRight, rowRight + cornersRight.cols);
+		}
+		results.push_back(result);
+	}
+	return true;
+}
+
+bool mergeCornerShards(const std::vector<std::string>& filenames,
+	cv::Size& patternSize, std::vector<PairCorners>& merged) {
+
+	merged.clear();
+	int expectedShardCount = -1;
+	std::vector<bool> seenShards;
+
+	for (const auto& filename : filenames) {
+		cv::Size shardPattern;
+		int shardIndex = -1, shardCount = -1;
+		std::vector<PairCorners> results;
+		if (!readCornerShard(filename, shardPattern, shardIndex, shardCount, results)) {
+			return false;
+		}
+
+		if (expectedShardCount < 0) {
+			expectedShardCount = shardCount;
+			patternSize = shardPattern;
+			seenShards.assign(shardCount, false);
+		}
+		if (shardCount != expectedShardCount || shardPattern != patternSize ||
+			shardIndex < 0 || shardIndex >= shardCount) {
+			std::cerr << "Error: Corner shard " << filename << " does not match the other shards\n";
+			return false;
+		}
+		if (seenShards[shardIndex]) {
+			std::cerr << "Error: Shard " << shardIndex << "/" << shardCount << " given twice (" << filename << ")\n";
+			return false;
+		}
+		seenShards[shardIndex] = true;
+		merged.insert(merged.end(), results.begin(), results.end());
+	}
+
+	for (int i = 0; i < static_cast<int>(seenShards.size()); ++i) {
+		if (!seenShards[i]) {
+			std::cerr << "Error: Missing corner shard " << i << "/" << expectedShardCount << "\n";
+			return false;
+		}
+	}
+
+	// Restore the order of the full pair list, independent of how it was split
+	std::sort(merged.begin(), merged.end(), [](const PairCorners& a, const PairCorners& b) {
+		return a.index < b.index;
+	});
+	for (size_t k = 1; k < merged.size(); ++k) {
+		if (merged[k].index == merged[k - 1].index) {
+			std::cerr << "Error: Pair " << merged[k].index << " appears in more than one shard\n";
+			return false;
+		}
+	}
+
+	return !filenames.empty();
+}
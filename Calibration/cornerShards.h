@@ -0,0 +1,48 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "chessboardDetector.h"
+
+/* Shardable corner detection for stereo calibration.
+ * The pair list is split into N contiguous slices (--shard i/N). Each process detects the corners
+ * in its slice and writes a compact corner file; mergeCornerShards() then puts all shards back
+ * in pair order. Because every pair is detected independently and the merged result is ordered
+ * by pair index, calibrateCamera and stereoCalibrate see the same inputs however the work was
+ * split.
+ */
+
+struct StereoPairJob {
+	int index; // Image number (457 for DSCF0457_L/R), sorted on to restore the pair order when merging
+	std::string leftPath;
+	std::string rightPath;
+};
+
+struct PairCorners {
+	int index = -1;
+	bool found = false; // True only if the board was found in both images
+	std::vector<cv::Point2f> left;
+	std::vector<cv::Point2f> right;
+};
+
+// Parses "i/N" with 0 <= i < N
+bool parseShardSpec(const std::string& spec, int& shardIndex, int& shardCount);
+
+// Contiguous slice of jobs for shard shardIndex of shardCount
+std::vector<StereoPairJob> shardSlice(const std::vector<StereoPairJob>& jobs, int shardIndex, int shardCount);
+
+// Detects corners in every pair (in parallel), results are in the same order as jobs
+std::vector<PairCorners> detectPairCorners(const std::vector<StereoPairJob>& jobs, ChessboardDetector& detector);
+
+// Corner files are written as base64 encoded FileStorage, compact and exact for floats
+void writeCornerShard(const std::string& filename, const cv::Size& patternSize,
+	int shardIndex, int shardCount, const std::vector<PairCorners>& results);
+
+bool readCornerShard(const std::string& filename, cv::Size& patternSize,
+	int& shardIndex, int& shardCount, std::vector<PairCorners>& results);
+
+// Reads and combines all shard files. Fails (with a message on stderr) if shards are missing,
+// duplicated, or were detected with different pattern sizes or shard counts.
+bool mergeCornerShards(const std::vector<std::string>& filenames,
+	cv::Size& patternSize, std::vector<PairCorners>& merged);
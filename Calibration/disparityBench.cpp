@@ -0,0 +1,120 @@
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include "stereoRectifier.h"
+#include "pyramidMatcher.h"
+#include "benchTiming.h"
+
+/* Runtime and accuracy of coarse-to-fine disparity against single level StereoBM.
+ * Runs today's quarter resolution StereoBM, then single level StereoBM and the pyramid matcher
+ * at half and full resolution. Accuracy is measured against single level StereoBM at the same
+ * resolution, over pixels both consider valid.
+ */
+
+struct DisparityAccuracy {
+	double coverage = 0.0;    // % of pixels with a valid disparity
+	double meanError = 0.0;   // Mean |d - reference| in pixels, where both are valid
+	double badPixels = 0.0;   // % of those pixels off by more than 1 pixel
+};
+
+static DisparityAccuracy compareDisparity(const cv::Mat& reference, const cv::Mat& disparity) {
+	DisparityAccuracy accuracy;
+	long valid = 0, both = 0, bad = 0;
+	double errorSum = 0.0;
+
+	for (int y = 0; y < disparity.rows; ++y) {
+		const short* referenceRow = reference.ptr<short>(y);
+		const short* disparityRow = disparity.ptr<short>(y);
+		for (int x = 0; x < disparity.cols; ++x) {
+			if (disparityRow[x] < 0) continue;
+			++valid;
+			if (referenceRow[x] < 0) continue;
+			const double error = std::abs(disparityRow[x] - referenceRow[x]) / 16.0;
+			++both;
+			errorSum += error;
+			if (error > 1.0) ++bad;
+		}
+	}
+
+	accuracy.coverage = 100.0 * valid / disparity.total();
+	accuracy.meanError = both > 0 ? errorSum / both : 0.0;
+	accuracy.badPixels = both > 0 ? 100.0 * bad / both : 0.0;
+	return accuracy;
+}
+
+static void printRow(BenchTable& table, const std::string& name, const cv::Size& size, double ms,
+	const DisparityAccuracy* accuracy) {
+	table.cell(name).cell(std::to_string(size.width) + "x" + std::to_string(size.height)).cell(ms);
+	if (accuracy) {
+		table.cell(accuracy->coverage).cell(accuracy->meanError).cell(accuracy->badPixels);
+	}
+	table.endRow();
+}
+
+int main(int argc, char* argv[]) {
+	// Command line parameters
+	// DisparityBench <image1> <image2> <calibration> [iterations]
+	if (argc < 4) {
+		std::cerr << "Usage: DisparityBench <image1> <image2> <calibration> [iterations]\n";
+		return -1;
+	}
+	cv::Mat image1 = cv::imread(argv[1]);
+	cv::Mat image2 = cv::imread(argv[2]);
+	if (image1.empty() || image2.empty()) {
+		std::cerr << "Error: Could not load one or both images.\n";
+		return -1;
+	}
+	const int iterations = argc > 4 ? std::max(1, std::stoi(argv[4])) : 5;
+	const int blockSize = 21; // Same as the stereo tool
+
+	BenchTable table(std::cout, {
+		{ "Method", 26 }, { "Size", 11 }, { "Time(ms)", 11 }, { "Valid(%)", 11 }, { "MAE(px)", 11 }, { ">1px(%)", 10 } });
+
+	// --- Quarter resolution StereoBM, as the stereo tool does today ---
+	{
+		const StereoRectifier rectifier = StereoRectifier::fromFile(argv[3], image1.size(), 0.25);
+		cv::Mat rectifiedL, rectifiedR, grayL, grayR, disparity;
+		rectifier.rectify(image1, image2, rectifiedL, rectifiedR);
+		cv::cvtColor(rectifiedL, grayL, cv::COLOR_BGR2GRAY);
+		cv::cvtColor(rectifiedR, grayR, cv::COLOR_BGR2GRAY);
+
+		cv::Ptr<cv::StereoBM> blockMatcher = cv::StereoBM::create(64, blockSize);
+		const double ms = medianMs([&]() { blockMatcher->compute(grayL, grayR, disparity); }, iterations);
+		printRow(table, "StereoBM 64 (today)", grayL.size(), ms, nullptr);
+	}
+
+	// --- Half and full resolution: single level against the pyramid ---
+	const double scales[] = { 0.5, 1.0 };
+	for (double scale : scales) {
+		const int levels = scale == 1.0 ? 2 : 1; // Coarse level is always quarter resolution
+		const int numDisparities = scale == 1.0 ? 256 : 128;
+
+		const StereoRectifier rectifier = StereoRectifier::fromFile(argv[3], image1.size(), scale);
+		cv::Mat rectifiedL, rectifiedR, grayL, grayR;
+		rectifier.rectify(image1, image2, rectifiedL, rectifiedR);
+		cv::cvtColor(rectifiedL, grayL, cv::COLOR_BGR2GRAY);
+		cv::cvtColor(rectifiedR, grayR, cv::COLOR_BGR2GRAY);
+
+		cv::Mat reference;
+		cv::Ptr<cv::StereoBM> blockMatcher = cv::StereoBM::create(numDisparities, blockSize);
+		const double singleMs = medianMs([&]() { blockMatcher->compute(grayL, grayR, reference); }, iterations);
+
+		PyramidMatcherOptions options;
+		options.levels = levels;
+		options.numDisparities = numDisparities;
+		options.blockSize = blockSize;
+		const PyramidStereoMatcher pyramidMatcher(options);
+
+		cv::Mat disparity;
+		const double pyramidMs = medianMs([&]() { pyramidMatcher.compute(grayL, grayR, disparity); }, iterations);
+
+		const DisparityAccuracy referenceAccuracy = compareDisparity(reference, reference);
+		const DisparityAccuracy pyramidAccuracy = compareDisparity(reference, disparity);
+		printRow(table, "StereoBM " + std::to_string(numDisparities), grayL.size(), singleMs, &referenceAccuracy);
+		printRow(table, "Pyramid " + std::to_string(numDisparities) + " (" + std::to_string(levels) + " levels)",
+			grayL.size(), pyramidMs, &pyramidAccuracy);
+	}
+
+	return 0;
+}
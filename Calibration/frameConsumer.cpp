@@ -0,0 +1,67 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <string>
+#include "frameRing.h"
+
+/* Small local consumer for frames published by the stereo tool.
+ * Attaches to the shared memory ring, reads every frame in place and prints its sequence,
+ * publish-to-read latency and the share of valid disparities.
+ */
+int main(int argc, char* argv[]) {
+	// Command line parameters
+	// FrameConsumer <shm-name> [frames] [--show]
+	if (argc < 2) {
+		std::cerr << "Usage: FrameConsumer <shm-name> [frames] [--show]\n";
+		return -1;
+	}
+	const std::string name = argv[1];
+	const long maxFrames = argc > 2 ? std::stol(argv[2]) : -1;
+	const bool show = argc > 3 && std::string(argv[3]) == "--show";
+
+	FrameRingReader reader(name);
+	std::cout << "Attached to " << name << " (" << reader.slotCount() << " slots)\n";
+
+	if (show) {
+		cv::namedWindow("Rectified Left", cv::WINDOW_NORMAL);
+		cv::namedWindow("Disparity", cv::WINDOW_NORMAL);
+	}
+
+	long framesRead = 0;
+	while (maxFrames < 0 || framesRead < maxFrames) {
+		FrameView view;
+		const FrameRingReader::Status status = reader.waitForFrame(view, 1000);
+		if (status == FrameRingReader::Status::NoNewFrame) {
+			continue;
+		}
+
+		const double latencyUs = (frameRingNowNs() - view.timestampNs) / 1000.0;
+
+		// Work directly on the shared memory, then make sure it was not overwritten meanwhile
+		const double validShare = static_cast<double>(cv::countNonZero(view.disparity > 0)) / view.disparity.total();
+		cv::Mat disparityDisplay;
+		if (show) {
+			cv::normalize(view.disparity, disparityDisplay, 0, 255, cv::NORM_MINMAX, CV_8U);
+			cv::imshow("Rectified Left", view.left);
+		}
+		if (!reader.stillValid(view)) {
+			std::cout << "Frame " << view.sequence << " overwritten while reading, skipped\n";
+			continue;
+		}
+
+		std::cout << "Frame " << view.sequence
+			<< (status == FrameRingReader::Status::Dropped ? " (after drop)" : "")
+			<< "  latency " << latencyUs << " us"
+			<< "  valid disparity " << 100.0 * validShare << "%"
+			<< "  dropped so far " << reader.droppedFrames() << "\n";
+		++framesRead;
+
+		if (show) {
+			cv::imshow("Disparity", disparityDisplay);
+			if (cv::waitKey(1) == 27) { // ESC key pressed
+				break;
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,409 @@
+#include "frameRing.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static const uint32_t frameRingMagic = 0x46524E47; // "FRNG"
+static const uint32_t frameRingVersion = 2;
+static const size_t frameRingAlignment = 64; // Cache line, keeps slots and images from sharing lines
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "atomics must be plain words to live in shared memory");
+
+// --- Shared memory layout: RingHeader, then slotCount slots of [SlotHeader, left, right, disparity] ---
+struct RingHeader {
+	std::atomic<uint32_t> magic; // Written last by the publisher, once the rest is valid
+	uint32_t version;
+	int32_t slotCount;
+	int32_t imageWidth, imageHeight, imageType;
+	int32_t disparityWidth, disparityHeight, disparityType;
+	uint64_t headerBytes;
+	uint64_t slotBytes;
+	uint64_t leftOffset, rightOffset, disparityOffset; // Offsets within a slot
+	std::atomic<uint64_t> latestSequence;              // Newest committed frame, 0 if none yet
+	int32_t publisherPid;
+	std::atomic<uint32_t> closed;                      // Set by the publisher's destructor
+};
+
+struct SlotHeader {
+	std::atomic<uint64_t> writeSequence;  // Set before the slot is written
+	std::atomic<uint64_t> commitSequence; // Set once the slot is fully written
+	int64_t timestampNs;
+	double Q[16];
+};
+
+static size_t alignUp(size_t value) {
+	return (value + frameRingAlignment - 1) / frameRingAlignment * frameRingAlignment;
+}
+
+static std::string shmName(const std::string& name) {
+	return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+static void throwErrno(const std::string& what) {
+	CV_Error(cv::Error::StsError, what + ": " + std::strerror(errno));
+}
+
+static const RingHeader* ringHeader(const unsigned char* base) {
+	return reinterpret_cast<const RingHeader*>(base);
+}
+
+// A segment is live while its publisher has not closed it and the process still exists
+static bool headerLive(const RingHeader* header) {
+	if (header->closed.load(std::memory_order_acquire) != 0) {
+		return false;
+	}
+	return kill(header->publisherPid, 0) == 0 || errno == EPERM;
+}
+
+// Checks whether /name currently belongs to a running publisher
+static bool segmentLive(const std::string& name) {
+	const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0) {
+		return false;
+	}
+
+	bool live = false;
+	struct stat info;
+	if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(RingHeader)) {
+		void* mapped = mmap(nullptr, sizeof(RingHeader), PROT_READ, MAP_SHARED, fd, 0);
+		if (mapped != MAP_FAILED) {
+			const RingHeader* header = static_cast<const RingHeader*>(mapped);
+			live = header->magic.load(std::memory_order_acquire) == frameRingMagic &&
+				header->version == frameRingVersion && headerLive(header);
+			munmap(mapped, sizeof(RingHeader));
+		}
+	}
+	close(fd);
+	return live;
+}
+
+static const unsigned char* slotBase(const unsigned char* base, uint64_t sequence) {
+	const RingHeader* header = ringHeader(base);
+	return base + header->headerBytes + (sequence % header->slotCount) * header->slotBytes;
+}
+
+// Builds Mat headers over a slot, nothing is copied
+static FrameView slotView(const unsigned char* base, uint64_t sequence) {
+	const RingHeader* header = ringHeader(base);
+	unsigned char* slot = const_cast<unsigned char*>(slotBase(base, sequence));
+	SlotHeader* slotHeader = reinterpret_cast<SlotHeader*>(slot);
+
+	FrameView view;
+	view.sequence = sequence;
+	view.timestampNs = slotHeader->timestampNs;
+	view.left = cv::Mat(header->imageHeight, header->imageWidth, header->imageType, slot + header->leftOffset);
+	view.right = cv::Mat(header->imageHeight, header->imageWidth, header->imageType, slot + header->rightOffset);
+	view.disparity = cv::Mat(header->disparityHeight, header->disparityWidth, header->disparityType, slot + header->disparityOffset);
+	view.Q = cv::Mat(4, 4, CV_64F, slotHeader->Q);
+	return view;
+}
+
+int64_t frameRingNowNs() {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return static_cast<int64_t>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
+
+// ===== Publisher =====
+
+FrameRingPublisher::FrameRingPublisher(const std::string& name, int slotCount,
+	const cv::Size& imageSize, int imageType,
+	const cv::Size& disparitySize, int disparityType)
+	: name_(shmName(name)) {
+
+	CV_Assert(slotCount >= 2);
+	CV_Assert(imageSize.area() > 0 && disparitySize.area() > 0);
+
+	// Readers in other processes need the sequence words to be lock free, check before creating anything
+	const std::atomic<uint64_t> sequenceProbe(0);
+	CV_Assert(sequenceProbe.is_lock_free());
+
+	const size_t imageBytes = alignUp(static_cast<size_t>(imageSize.area()) * CV_ELEM_SIZE(imageType));
+	const size_t disparityBytes = alignUp(static_cast<size_t>(disparitySize.area()) * CV_ELEM_SIZE(disparityType));
+	const size_t slotHeaderBytes = alignUp(sizeof(SlotHeader));
+	const size_t headerBytes = alignUp(sizeof(RingHeader));
+	const size_t slotBytes = slotHeaderBytes + 2 * imageBytes + disparityBytes;
+	mappedBytes_ = headerBytes + slotCount * slotBytes;
+
+	// Replace any segment left behind by a previous run, but never one that is still published
+	if (segmentLive(name_)) {
+		CV_Error(cv::Error::StsError, "Shared memory segment " + name_ + " is in use by a running publisher");
+	}
+	shm_unlink(name_.c_str());
+	fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd_ < 0) {
+		throwErrno("shm_open " + name_);
+	}
+	if (ftruncate(fd_, static_cast<off_t>(mappedBytes_)) != 0) {
+		close(fd_);
+		shm_unlink(name_.c_str());
+		throwErrno("ftruncate " + name_);
+	}
+	void* mapped = mmap(nullptr, mappedBytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+	if (mapped == MAP_FAILED) {
+		close(fd_);
+		shm_unlink(name_.c_str());
+		throwErrno("mmap " + name_);
+	}
+	base_ = static_cast<unsigned char*>(mapped); // ftruncate zero fills, so all sequences start at 0
+
+	RingHeader* header = reinterpret_cast<RingHeader*>(base_);
+	header->version = frameRingVersion;
+	header->slotCount = slotCount;
+	header->imageWidth = imageSize.width;
+	header->imageHeight = imageSize.height;
+	header->imageType = imageType;
+	header->disparityWidth = disparitySize.width;
+	header->disparityHeight = disparitySize.height;
+	header->disparityType = disparityType;
+	header->headerBytes = headerBytes;
+	header->slotBytes = slotBytes;
+	header->leftOffset = slotHeaderBytes;
+	header->rightOffset = slotHeaderBytes + imageBytes;
+	header->disparityOffset = slotHeaderBytes + 2 * imageBytes;
+	header->publisherPid = static_cast<int32_t>(getpid());
+	header->magic.store(frameRingMagic, std::memory_order_release);
+}
+
+FrameRingPublisher::~FrameRingPublisher() {
+	if (base_) {
+		// Tell attached readers to look for a new segment
+		reinterpret_cast<RingHeader*>(base_)->closed.store(1, std::memory_order_release);
+		munmap(base_, mappedBytes_);
+	}
+	if (fd_ >= 0) {
+		close(fd_);
+		shm_unlink(name_.c_str());
+	}
+}
+
+FrameView FrameRingPublisher::reserve() {
+	CV_Assert(!reserved_);
+	const uint64_t sequence = nextSequence_;
+
+	// Mark the slot as being written before touching its contents, so readers still holding
+	// the old frame can tell it has gone
+	SlotHeader* slotHeader = reinterpret_cast<SlotHeader*>(const_cast<unsigned char*>(slotBase(base_, sequence)));
+	slotHeader->writeSequence.store(sequence, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	reserved_ = true;
+	return slotView(base_, sequence);
+}
+
+void FrameRingPublisher::commit(const FrameView& view) {
+	CV_Assert(reserved_ && view.sequence == nextSequence_);
+
+	SlotHeader* slotHeader = reinterpret_cast<SlotHeader*>(const_cast<unsigned char*>(slotBase(base_, view.sequence)));
+	slotHeader->timestampNs = frameRingNowNs();
+	slotHeader->commitSequence.store(view.sequence, std::memory_order_release);
+
+	RingHeader* header = reinterpret_cast<RingHeader*>(base_);
+	header->latestSequence.store(view.sequence, std::memory_order_release);
+
+	reserved_ = false;
+	++nextSequence_;
+}
+
+uint64_t FrameRingPublisher::publish(const cv::Mat& left, const cv::Mat& right,
+	const cv::Mat& disparity, const cv::Mat& Q) {
+
+	// Check against the ring layout before reserving, so a bad frame leaves the slot and the
+	// publisher untouched
+	const RingHeader* header = ringHeader(base_);
+	const cv::Size imageSize(header->imageWidth, header->imageHeight);
+	const cv::Size disparitySize(header->disparityWidth, header->disparityHeight);
+	CV_Assert(left.size() == imageSize && left.type() == header->imageType);
+	CV_Assert(right.size() == imageSize && right.type() == header->imageType);
+	CV_Assert(disparity.size() == disparitySize && disparity.type() == header->disparityType);
+	CV_Assert(Q.rows == 4 && Q.cols == 4 && Q.channels() == 1);
+
+	FrameView view = reserve();
+
+	// Sizes and types match, so these write into the slot rather than reallocating
+	left.copyTo(view.left);
+	right.copyTo(view.right);
+	disparity.copyTo(view.disparity);
+	Q.convertTo(view.Q, CV_64F);
+
+	commit(view);
+	return view.sequence;
+}
+
+uint64_t FrameRingPublisher::lastSequence() const {
+	return nextSequence_ - 1;
+}
+
+// ===== Reader =====
+
+FrameRingReader::FrameRingReader(const std::string& name)
+	: name_(shmName(name)) {
+	attach(true);
+}
+
+FrameRingReader::~FrameRingReader() {
+	detach();
+}
+
+bool FrameRingReader::attach(bool throwOnError) {
+	const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+	if (fd < 0) {
+		if (throwOnError) throwErrno("shm_open " + name_);
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(RingHeader)) {
+		close(fd);
+		if (throwOnError) CV_Error(cv::Error::StsError, "Shared memory segment " + name_ + " is not a frame ring");
+		return false;
+	}
+	const size_t mappedBytes = static_cast<size_t>(info.st_size);
+
+	void* mapped = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+	if (mapped == MAP_FAILED) {
+		close(fd);
+		if (throwOnError) throwErrno("mmap " + name_);
+		return false;
+	}
+
+	const RingHeader* header = static_cast<const RingHeader*>(mapped);
+	if (header->magic.load(std::memory_order_acquire) != frameRingMagic || header->version != frameRingVersion ||
+		header->headerBytes + header->slotCount * header->slotBytes > mappedBytes) {
+		munmap(mapped, mappedBytes);
+		close(fd);
+		if (throwOnError) CV_Error(cv::Error::StsError, "Shared memory segment " + name_ + " is not a compatible frame ring");
+		return false;
+	}
+
+	detach();
+	fd_ = fd;
+	mappedBytes_ = mappedBytes;
+	base_ = static_cast<const unsigned char*>(mapped);
+	nextSequence_ = 0; // Start at the newest frame of the new segment
+	return true;
+}
+
+void FrameRingReader::detach() {
+	if (base_) {
+		munmap(const_cast<unsigned char*>(base_), mappedBytes_);
+		base_ = nullptr;
+	}
+	if (fd_ >= 0) {
+		close(fd_);
+		fd_ = -1;
+	}
+}
+
+bool FrameRingReader::publisherAlive() const {
+	return headerLive(ringHeader(base_));
+}
+
+bool FrameRingReader::reattachIfReplaced() {
+	bool replaced = !publisherAlive();
+	if (!replaced) {
+		// A new publisher may have taken over the name while the old one still runs its shutdown
+		struct stat attached, current;
+		const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+		if (fd < 0) {
+			return false;
+		}
+		replaced = fstat(fd_, &attached) == 0 && fstat(fd, &current) == 0 &&
+			(attached.st_ino != current.st_ino || attached.st_dev != current.st_dev);
+		close(fd);
+	}
+
+	// Only follow a segment that is itself live, otherwise keep the old one
+	return replaced && segmentLive(name_) && attach(false);
+}
+
+int FrameRingReader::slotCount() const {
+	return ringHeader(base_)->slotCount;
+}
+
+bool FrameRingReader::readSlot(uint64_t sequence, FrameView& view) const {
+	const SlotHeader* slotHeader = reinterpret_cast<const SlotHeader*>(slotBase(base_, sequence));
+	if (slotHeader->commitSequence.load(std::memory_order_acquire) != sequence) {
+		return false;
+	}
+	view = slotView(base_, sequence);
+	return stillValid(view); // The timestamp must not come from a newer frame
+}
+
+bool FrameRingReader::stillValid(const FrameView& view) const {
+	const SlotHeader* slotHeader = reinterpret_cast<const SlotHeader*>(slotBase(base_, view.sequence));
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slotHeader->writeSequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+FrameRingReader::Status FrameRingReader::acquire(FrameView& view) {
+	const RingHeader* header = ringHeader(base_);
+	Status status = Status::Ok;
+
+	for (;;) {
+		const uint64_t latest = header->latestSequence.load(std::memory_order_acquire);
+		if (latest == 0) {
+			return Status::NoNewFrame;
+		}
+		if (nextSequence_ == 0) {
+			nextSequence_ = latest; // Late joiners start at the newest frame
+		}
+		if (nextSequence_ > latest) {
+			return Status::NoNewFrame;
+		}
+
+		// Lapped by the publisher: skip ahead rather than hold it up
+		if (latest - nextSequence_ >= static_cast<uint64_t>(header->slotCount)) {
+			dropped_ += latest - nextSequence_;
+			nextSequence_ = latest;
+			status = Status::Dropped;
+		}
+
+		if (readSlot(nextSequence_, view)) {
+			++nextSequence_;
+			return status;
+		}
+
+		// The slot was reused between the checks above, retry from the newest frame
+		const uint64_t newest = header->latestSequence.load(std::memory_order_acquire);
+		dropped_ += newest - nextSequence_;
+		nextSequence_ = newest;
+		status = Status::Dropped;
+	}
+}
+
+FrameRingReader::Status FrameRingReader::waitForFrame(FrameView& view, int timeoutMs, bool spin) {
+	const int spinPolls = 1000; // Roughly tens of microseconds of yielding before sleeping
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int polls = 0;; ++polls) {
+		const Status status = acquire(view);
+		if (status != Status::NoNewFrame) {
+			return status;
+		}
+		if (timeoutMs >= 0 && std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(timeoutMs)) {
+			return Status::NoNewFrame;
+		}
+
+		if (spin || polls < spinPolls) {
+			std::this_thread::yield();
+		}
+		else {
+			// Idle: back off, and follow the publisher if it was restarted
+			std::this_thread::sleep_for(std::chrono::microseconds(500));
+			if (polls % 200 == 0) {
+				reattachIfReplaced();
+			}
+		}
+	}
+}
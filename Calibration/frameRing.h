@@ -0,0 +1,120 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* Shared memory ring buffer for rectified stereo frames (POSIX only).
+ *
+ * One publisher process owns the segment and writes frames into a fixed number of slots, each
+ * holding the rectified left/right images, the disparity map and Q. Every published frame gets
+ * an increasing sequence number. Readers map the segment read-only and get cv::Mat headers that
+ * point straight into shared memory, so no pixels are copied.
+ *
+ * The publisher never waits for readers. Each slot is guarded by a sequence lock: if a reader
+ * falls more than slotCount frames behind, or a slot is overwritten while it is being read, the
+ * reader notices, counts the frames it missed as dropped and resynchronises on the newest frame.
+ *
+ * A publisher refuses to replace a segment whose publisher is still running. Readers notice when
+ * their publisher has exited or its segment was replaced by a new run, and re-attach on their own.
+ */
+
+// Zero-copy view of one published frame. The Mats are only valid until the publisher wraps
+// around to the same slot, check FrameRingReader::stillValid() after using them.
+// Views returned by FrameRingReader point into a read-only mapping: treat the Mats as const,
+// writing into them crashes the reader. clone() a Mat to modify it.
+struct FrameView {
+	uint64_t sequence = 0;
+	int64_t timestampNs = 0; // CLOCK_MONOTONIC time the frame was committed
+	cv::Mat left;
+	cv::Mat right;
+	cv::Mat disparity;
+	cv::Mat Q; // 4x4 CV_64F
+};
+
+class FrameRingPublisher {
+public:
+	// Creates the shared memory segment /name, replacing one left by a publisher that has exited.
+	// Throws if a running publisher still owns it.
+	FrameRingPublisher(const std::string& name, int slotCount,
+		const cv::Size& imageSize, int imageType,
+		const cv::Size& disparitySize, int disparityType);
+	~FrameRingPublisher();
+
+	FrameRingPublisher(const FrameRingPublisher&) = delete;
+	FrameRingPublisher& operator=(const FrameRingPublisher&) = delete;
+
+	// Copies one frame into the next slot and publishes it. Returns its sequence number.
+	uint64_t publish(const cv::Mat& left, const cv::Mat& right,
+		const cv::Mat& disparity, const cv::Mat& Q);
+
+	// Two step form for producers that can write straight into shared memory (e.g. cv::remap
+	// into view.left): reserve() hands out the next slot, commit() publishes it.
+	FrameView reserve();
+	void commit(const FrameView& view);
+
+	uint64_t lastSequence() const;
+	const std::string& name() const { return name_; }
+
+private:
+	std::string name_;
+	int fd_ = -1;
+	size_t mappedBytes_ = 0;
+	unsigned char* base_ = nullptr;
+	uint64_t nextSequence_ = 1;
+	bool reserved_ = false;
+};
+
+class FrameRingReader {
+public:
+	enum class Status {
+		Ok,         // view holds a new frame
+		NoNewFrame, // nothing newer than the last frame read
+		Dropped     // the reader fell behind; view holds the newest frame instead
+	};
+
+	// Attaches read-only to an existing segment created by FrameRingPublisher
+	explicit FrameRingReader(const std::string& name);
+	~FrameRingReader();
+
+	FrameRingReader(const FrameRingReader&) = delete;
+	FrameRingReader& operator=(const FrameRingReader&) = delete;
+
+	// Non-blocking: fetches the next frame in sequence if one has been published
+	Status acquire(FrameView& view);
+
+	// Polls acquire() until a frame arrives or timeoutMs passes (negative waits forever).
+	// After a short spin it sleeps between polls and re-attaches if the segment was replaced;
+	// spin = true never sleeps, for latency measurements only, as it keeps a core busy.
+	Status waitForFrame(FrameView& view, int timeoutMs, bool spin = false);
+
+	// Re-attaches if the publisher closed or replaced the segment and a new one exists under the
+	// same name. Returns true if the reader now follows a new segment, which invalidates any
+	// FrameView acquired before.
+	bool reattachIfReplaced();
+
+	// True while the publisher of the attached segment is running
+	bool publisherAlive() const;
+
+	// True if the slot behind view has not been overwritten since acquire()
+	bool stillValid(const FrameView& view) const;
+
+	uint64_t droppedFrames() const { return dropped_; }
+	int slotCount() const;
+
+private:
+	bool attach(bool throwOnError);
+	void detach();
+	bool readSlot(uint64_t sequence, FrameView& view) const;
+
+	std::string name_;
+	int fd_ = -1;
+	size_t mappedBytes_ = 0;
+	const unsigned char* base_ = nullptr;
+	uint64_t nextSequence_ = 0; // 0 until the first acquire(), which starts at the newest frame
+	uint64_t dropped_ = 0;
+};
+
+// CLOCK_MONOTONIC in nanoseconds, the clock used for FrameView::timestampNs
+int64_t frameRingNowNs();
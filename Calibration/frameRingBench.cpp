@@ -0,0 +1,118 @@
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "frameRing.h"
+
+/* Latency benchmark for the shared memory frame ring.
+ * Forks a reader process, publishes synthetic frames at a fixed interval and reports the
+ * publish-to-read latency seen by the reader, the publisher's per-frame cost and dropped frames.
+ */
+
+static double percentile(std::vector<double>& values, double p) {
+	if (values.empty()) return 0.0;
+	const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+static int runReader(const std::string& name, uint64_t frameCount) {
+	FrameRingReader reader(name);
+	std::vector<double> latencies;
+	latencies.reserve(static_cast<size_t>(frameCount));
+	long overwritten = 0;
+	uint64_t checksum = 0;
+
+	for (;;) {
+		FrameView view;
+		if (reader.waitForFrame(view, 2000, true) == FrameRingReader::Status::NoNewFrame) {
+			break; // Publisher finished or went away
+		}
+		const double latencyUs = (frameRingNowNs() - view.timestampNs) / 1000.0;
+
+		// Touch the payload in place, as a real consumer would
+		checksum += view.left.data[0] + view.disparity.data[view.disparity.total() - 1];
+		if (reader.stillValid(view)) {
+			latencies.push_back(latencyUs);
+		}
+		else {
+			++overwritten;
+		}
+		if (view.sequence >= frameCount) {
+			break;
+		}
+	}
+
+	std::cout << "\n=== Frame Ring Reader ===\n";
+	std::cout << "Frames read: " << latencies.size() << " / " << frameCount << "\n";
+	std::cout << "Dropped (lapped): " << reader.droppedFrames() << "  Overwritten while reading: " << overwritten << "\n";
+	std::cout << "Latency p50 = " << percentile(latencies, 0.50) << " us"
+		<< "  p90 = " << percentile(latencies, 0.90) << " us"
+		<< "  p99 = " << percentile(latencies, 0.99) << " us"
+		<< "  max = " << percentile(latencies, 1.0) << " us\n";
+	std::cout << "(checksum " << checksum << ")\n";
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	// Command line parameters
+	// FrameRingBench [frames] [width] [height] [interval-us] [slots]
+	const uint64_t frameCount = argc > 1 ? std::stoull(argv[1]) : 2000;
+	const cv::Size imageSize(argc > 2 ? std::stoi(argv[2]) : 480, argc > 3 ? std::stoi(argv[3]) : 270); // Quarter of 1920x1080
+	const int intervalUs = argc > 4 ? std::stoi(argv[4]) : 1000;
+	const int slotCount = argc > 5 ? std::stoi(argv[5]) : 8;
+	const std::string name = "/calibration_frame_ring_bench";
+
+	FrameRingPublisher publisher(name, slotCount, imageSize, CV_8UC3, imageSize, CV_16SC1);
+
+	const pid_t child = fork();
+	if (child < 0) {
+		std::cerr << "Error: fork failed\n";
+		return -1;
+	}
+	if (child == 0) {
+		// Skip the inherited publisher's destructor, it would unlink the segment
+		const int result = runReader(name, frameCount);
+		std::cout.flush();
+		_exit(result);
+	}
+
+	// --- Synthetic frames ---
+	cv::Mat left(imageSize, CV_8UC3), right(imageSize, CV_8UC3), disparity(imageSize, CV_16SC1);
+	cv::randu(left, cv::Scalar::all(0), cv::Scalar::all(255));
+	cv::randu(right, cv::Scalar::all(0), cv::Scalar::all(255));
+	cv::randu(disparity, cv::Scalar::all(0), cv::Scalar::all(64 * 16));
+	const cv::Mat Q = cv::Mat::eye(4, 4, CV_64F);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Let the reader attach
+
+	std::vector<double> publishUs;
+	publishUs.reserve(static_cast<size_t>(frameCount));
+	auto nextFrame = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < frameCount; ++i) {
+		const auto start = std::chrono::steady_clock::now();
+		publisher.publish(left, right, disparity, Q);
+		publishUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+		nextFrame += std::chrono::microseconds(intervalUs);
+		std::this_thread::sleep_until(nextFrame);
+	}
+
+	int childStatus = 0;
+	waitpid(child, &childStatus, 0);
+
+	std::cout << "\n=== Frame Ring Publisher ===\n";
+	std::cout << "Frame size " << imageSize.width << "x" << imageSize.height
+		<< ", " << slotCount << " slots, one frame every " << intervalUs << " us\n";
+	std::cout << "Publish cost p50 = " << percentile(publishUs, 0.50) << " us"
+		<< "  p99 = " << percentile(publishUs, 0.99) << " us\n";
+
+	return 0;
+}
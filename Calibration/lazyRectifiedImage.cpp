@@ -0,0 +1,167 @@
+#include "lazyRectifiedImage.h"
+
+#include <algorithm>
+#include <thread>
+
+enum TileState {
+	TileEmpty = 0,
+	TileComputing = 1,
+	TileReady = 2
+};
+
+LazyRectifiedImage::LazyRectifiedImage(const StereoRectifier& rectifier, StereoCamera camera, int tileSize)
+	: rectifier_(rectifier),
+	camera_(camera),
+	tileSize_(tileSize) {
+
+	CV_Assert(tileSize > 0);
+	const cv::Size outputSize = rectifier.outputSize();
+	grid_ = cv::Size((outputSize.width + tileSize - 1) / tileSize, (outputSize.height + tileSize - 1) / tileSize);
+	tileState_.reset(new std::atomic<int>[grid_.area()]);
+	for (int i = 0; i < grid_.area(); ++i) {
+		tileState_[i].store(TileEmpty, std::memory_order_relaxed);
+	}
+}
+
+LazyRectifiedImage::LazyRectifiedImage(const StereoRectifier& rectifier, StereoCamera camera,
+	const cv::Mat& source, int tileSize)
+	: LazyRectifiedImage(rectifier, camera, tileSize) {
+	reset(source);
+}
+
+void LazyRectifiedImage::reset(const cv::Mat& source) {
+	CV_Assert(source.size() == rectifier_.imageSize());
+
+	source_ = source;
+
+	// Mats handed out for the previous frame may still be in use, give this frame its own buffer
+	// rather than writing the new tiles into them
+	if (rectified_.u && rectified_.u->refcount > 1) {
+		rectified_.release();
+	}
+	rectified_.create(rectifier_.outputSize(), source.type());
+	for (int i = 0; i < grid_.area(); ++i) {
+		tileState_[i].store(TileEmpty, std::memory_order_relaxed);
+	}
+
+	std::lock_guard<std::mutex> lock(previewMutex_);
+	preview_.release();
+	previewScale_ = 0.0;
+}
+
+cv::Rect LazyRectifiedImage::tileRect(int tileX, int tileY) const {
+	CV_Assert(tileX >= 0 && tileX < grid_.width && tileY >= 0 && tileY < grid_.height);
+	const cv::Rect tile(tileX * tileSize_, tileY * tileSize_, tileSize_, tileSize_);
+	return tile & cv::Rect(cv::Point(0, 0), rectifier_.outputSize());
+}
+
+void LazyRectifiedImage::ensureTile(int tileX, int tileY) {
+	std::atomic<int>& state = tileState_[tileY * grid_.width + tileX];
+	if (state.load(std::memory_order_acquire) == TileReady) {
+		return;
+	}
+
+	int expected = TileEmpty;
+	if (state.compare_exchange_strong(expected, TileComputing, std::memory_order_acquire)) {
+		try {
+			const cv::Rect region = tileRect(tileX, tileY);
+			cv::Mat destination = rectified_(region);
+			rectifier_.rectifyRegion(source_, camera_, region, destination);
+		}
+		catch (...) {
+			// Release the claim so waiting readers retry instead of spinning forever
+			state.store(TileEmpty, std::memory_order_release);
+			throw;
+		}
+		state.store(TileReady, std::memory_order_release);
+		return;
+	}
+
+	// Another thread is computing this tile, tiles are small so wait for it. If that thread
+	// failed the tile is empty again, and this thread makes its own attempt.
+	int current = state.load(std::memory_order_acquire);
+	while (current == TileComputing) {
+		std::this_thread::yield();
+		current = state.load(std::memory_order_acquire);
+	}
+	if (current == TileEmpty) {
+		ensureTile(tileX, tileY);
+	}
+}
+
+cv::Mat LazyRectifiedImage::roi(const cv::Rect& region) {
+	CV_Assert(!source_.empty());
+	const cv::Rect clipped = region & cv::Rect(cv::Point(0, 0), rectifier_.outputSize());
+	if (clipped.empty()) {
+		return cv::Mat();
+	}
+
+	const int firstX = clipped.x / tileSize_;
+	const int firstY = clipped.y / tileSize_;
+	const int lastX = (clipped.x + clipped.width - 1) / tileSize_;
+	const int lastY = (clipped.y + clipped.height - 1) / tileSize_;
+	for (int tileY = firstY; tileY <= lastY; ++tileY) {
+		for (int tileX = firstX; tileX <= lastX; ++tileX) {
+			ensureTile(tileX, tileY);
+		}
+	}
+
+	return rectified_(clipped);
+}
+
+cv::Mat LazyRectifiedImage::tile(int tileX, int tileY) {
+	CV_Assert(!source_.empty());
+	ensureTile(tileX, tileY);
+	return rectified_(tileRect(tileX, tileY));
+}
+
+cv::Mat LazyRectifiedImage::full() {
+	CV_Assert(!source_.empty());
+
+	// Missing tiles in parallel; ensureTile() keeps this safe alongside other readers
+	cv::parallel_for_(cv::Range(0, grid_.area()), [&](const cv::Range& range) {
+		for (int i = range.start; i < range.end; ++i) {
+			ensureTile(i % grid_.width, i / grid_.width);
+		}
+	});
+
+	return rectified_;
+}
+
+cv::Mat LazyRectifiedImage::preview(double scale) {
+	CV_Assert(!source_.empty() && scale > 0.0 && scale <= 1.0);
+
+	std::lock_guard<std::mutex> lock(previewMutex_);
+	if (!preview_.empty() && previewScale_ == scale) {
+		return preview_;
+	}
+
+	const cv::Size outputSize = rectifier_.outputSize();
+	const cv::Size previewSize(std::max(1, cvRound(outputSize.width * scale)), std::max(1, cvRound(outputSize.height * scale)));
+
+	// Low-pass the source by downscaling it to roughly the preview's sampling rate
+	const double sourceScale = std::min(1.0, static_cast<double>(previewSize.width) / source_.cols);
+	cv::Mat smallSource = source_;
+	if (sourceScale < 1.0) {
+		cv::resize(source_, smallSource, cv::Size(), sourceScale, sourceScale, cv::INTER_AREA);
+	}
+
+	if (previewMapSize_ != previewSize) {
+		rectifier_.previewMaps(camera_, previewSize, smallSource.size(), previewMapX_, previewMapY_);
+		previewMapSize_ = previewSize;
+	}
+	cv::remap(smallSource, preview_, previewMapX_, previewMapY_, rectifier_.interpolation());
+
+	previewScale_ = scale;
+	return preview_;
+}
+
+int LazyRectifiedImage::computedTiles() const {
+	int ready = 0;
+	for (int i = 0; i < grid_.area(); ++i) {
+		if (tileState_[i].load(std::memory_order_acquire) == TileReady) {
+			++ready;
+		}
+	}
+	return ready;
+}
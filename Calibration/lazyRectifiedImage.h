@@ -0,0 +1,70 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "stereoRectifier.h"
+
+/* Rectified view of one camera's frame that is computed lazily, tile by tile.
+ * Nothing is remapped up front; roi(), tile() and full() rectify only the tiles they touch that
+ * have not been computed yet for the current frame, so consumers that read a region pay only for
+ * its pixels. Tiles are cached until reset() moves the view to the next frame, which lets a full
+ * resolution matcher and ROI or preview consumers share one frame without computing it twice.
+ *
+ * Mats returned by roi(), tile() and full() are views into the frame's buffer: tiles not yet
+ * computed fill in as other consumers read them, and the view keeps the frame alive after reset().
+ *
+ * Accessors may be called concurrently; each tile is computed exactly once. reset() must not run
+ * while other threads are reading the view. The rectifier must outlive the view.
+ */
+class LazyRectifiedImage {
+public:
+	LazyRectifiedImage(const StereoRectifier& rectifier, StereoCamera camera, int tileSize = 128);
+	LazyRectifiedImage(const StereoRectifier& rectifier, StereoCamera camera, const cv::Mat& source, int tileSize = 128);
+
+	// Starts a new frame, dropping all cached tiles. The rectified buffer is reused unless a Mat
+	// returned for the previous frame still refers to it, so those keep the previous frame's
+	// pixels. source is not copied: it must stay unchanged until the next reset(), as tiles are
+	// remapped from it on demand.
+	void reset(const cv::Mat& source);
+
+	// Rectified pixels of region (clipped to the output image), as a view into the tile cache
+	cv::Mat roi(const cv::Rect& region);
+
+	// One tile of the grid, as a view into the tile cache
+	cv::Mat tile(int tileX, int tileY);
+
+	// The whole rectified frame
+	cv::Mat full();
+
+	// Downscaled preview, remapped directly at preview size from an INTER_AREA downscaled copy of
+	// the source. No full resolution tiles are computed for it, and the result does not depend on
+	// which tiles other consumers have already read.
+	cv::Mat preview(double scale);
+
+	cv::Rect tileRect(int tileX, int tileY) const;
+	const cv::Size& tileGrid() const { return grid_; }
+	int computedTiles() const;
+
+private:
+	void ensureTile(int tileX, int tileY);
+
+	const StereoRectifier& rectifier_;
+	StereoCamera camera_;
+	int tileSize_;
+	cv::Size grid_;
+
+	cv::Mat source_;
+	cv::Mat rectified_; // Output sized buffer, filled in tile by tile
+
+	// Per tile state for the current frame: 0 = not computed, 1 = being computed, 2 = ready
+	std::unique_ptr<std::atomic<int>[]> tileState_;
+
+	// Preview for the current frame, and preview remap tables kept across frames
+	std::mutex previewMutex_;
+	cv::Mat preview_;
+	double previewScale_ = 0.0;
+	cv::Size previewMapSize_;
+	cv::Mat previewMapX_, previewMapY_;
+};
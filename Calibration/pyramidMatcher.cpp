@@ -0,0 +1,150 @@
+#include "pyramidMatcher.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+PyramidStereoMatcher::PyramidStereoMatcher(const PyramidMatcherOptions& options)
+	: options_(options) {
+	CV_Assert(options.levels >= 0);
+	CV_Assert(options.numDisparities > 0);
+	CV_Assert(options.blockSize % 2 == 1 && options.refineBlockSize % 2 == 1);
+	CV_Assert(options.searchRadius >= 1);
+}
+
+void PyramidStereoMatcher::compute(const cv::Mat& left, const cv::Mat& right, cv::Mat& disparity) const {
+	CV_Assert(left.type() == CV_8UC1 && right.type() == CV_8UC1 && left.size() == right.size());
+
+	// --- Build the pyramids, index 0 is the finest level ---
+	std::vector<cv::Mat> pyramidLeft(options_.levels + 1), pyramidRight(options_.levels + 1);
+	pyramidLeft[0] = left;
+	pyramidRight[0] = right;
+	for (int level = 1; level <= options_.levels; ++level) {
+		cv::pyrDown(pyramidLeft[level - 1], pyramidLeft[level]);
+		cv::pyrDown(pyramidRight[level - 1], pyramidRight[level]);
+	}
+
+	// --- Full range search at the coarsest level ---
+	// StereoBM needs the range as a multiple of 16
+	const int coarseDisparities = ((((options_.numDisparities >> options_.levels) + 15) / 16) * 16);
+	cv::Ptr<cv::StereoBM> coarseMatcher = cv::StereoBM::create(coarseDisparities, options_.blockSize);
+
+	cv::Mat coarseFixed;
+	coarseMatcher->compute(pyramidLeft[options_.levels], pyramidRight[options_.levels], coarseFixed);
+
+	cv::Mat estimate;
+	coarseFixed.convertTo(estimate, CV_32F, 1.0 / 16.0);
+	estimate.setTo(-1.0f, coarseFixed < 0);
+
+	// --- Narrow band refinement at every finer level ---
+	for (int level = options_.levels - 1; level >= 0; --level) {
+		const cv::Size levelSize = pyramidLeft[level].size();
+
+		// Nearest neighbour keeps invalid pixels from bleeding into valid ones
+		cv::Mat prior;
+		cv::resize(estimate, prior, levelSize, 0, 0, cv::INTER_NEAREST);
+		prior *= 2.0;
+
+		const int levelDisparities = (options_.numDisparities + (1 << level) - 1) >> level;
+		refineLevel(pyramidLeft[level], pyramidRight[level], prior, levelDisparities, estimate);
+	}
+
+	// --- Back to StereoBM's fixed point encoding ---
+	cv::Mat invalid = estimate < 0;
+	estimate.convertTo(disparity, CV_16S, 16.0);
+	disparity.setTo(-16, invalid);
+}
+
+void PyramidStereoMatcher::refineLevel(const cv::Mat& left, const cv::Mat& right, const cv::Mat& prior,
+	int numDisparities, cv::Mat& refined) const {
+
+	const int radius = options_.searchRadius;
+	const int candidates = 2 * radius + 1;
+	const cv::Size size = left.size();
+	const cv::Size window(options_.refineBlockSize, options_.refineBlockSize);
+
+	// Integer centre of the search band for every pixel
+	cv::Mat base(size, CV_32S);
+	for (int y = 0; y < size.height; ++y) {
+		const float* priorRow = prior.ptr<float>(y);
+		int* baseRow = base.ptr<int>(y);
+		for (int x = 0; x < size.width; ++x) {
+			baseRow[x] = priorRow[x] < 0 ? -1 : cvRound(priorRow[x]);
+		}
+	}
+
+	// --- Aggregated SAD cost for each offset in the band ---
+	// Each pixel is compared against the right image shifted by its own band centre, so the
+	// window sums assume the disparity is locally smooth, like any per-pixel warped matcher.
+	// Pixels without a prior contribute nothing, and each sum is divided by the number of valid
+	// pixels in its window, so holes and the invalid left band do not pull their neighbours'
+	// costs towards disparity 0.
+	cv::Mat validCount;
+	cv::boxFilter(base >= 0, validCount, CV_32F, window, cv::Point(-1, -1), false, cv::BORDER_REPLICATE);
+	validCount *= 1.0 / 255.0; // The mask is 0/255
+	cv::max(validCount, 1.0, validCount);
+
+	std::vector<cv::Mat> costs(candidates);
+	cv::Mat difference(size, CV_8U);
+	for (int c = 0; c < candidates; ++c) {
+		const int offset = c - radius;
+		cv::parallel_for_(cv::Range(0, size.height), [&](const cv::Range& rows) {
+			for (int y = rows.start; y < rows.end; ++y) {
+				const uchar* leftRow = left.ptr<uchar>(y);
+				const uchar* rightRow = right.ptr<uchar>(y);
+				const int* baseRow = base.ptr<int>(y);
+				uchar* differenceRow = difference.ptr<uchar>(y);
+				for (int x = 0; x < size.width; ++x) {
+					if (baseRow[x] < 0) {
+						differenceRow[x] = 0;
+						continue;
+					}
+					const int xr = std::min(std::max(x - baseRow[x] - offset, 0), size.width - 1);
+					differenceRow[x] = static_cast<uchar>(std::abs(leftRow[x] - rightRow[xr]));
+				}
+			}
+		});
+		cv::boxFilter(difference, costs[c], CV_32F, window, cv::Point(-1, -1), false, cv::BORDER_REPLICATE);
+		cv::divide(costs[c], validCount, costs[c]);
+	}
+
+	// --- Winner takes all over the band, with parabolic sub-pixel interpolation ---
+	refined.create(size, CV_32F);
+	cv::parallel_for_(cv::Range(0, size.height), [&](const cv::Range& rows) {
+		for (int y = rows.start; y < rows.end; ++y) {
+			const int* baseRow = base.ptr<int>(y);
+			float* refinedRow = refined.ptr<float>(y);
+			std::vector<const float*> costRows(candidates);
+			for (int c = 0; c < candidates; ++c) {
+				costRows[c] = costs[c].ptr<float>(y);
+			}
+
+			for (int x = 0; x < size.width; ++x) {
+				if (baseRow[x] < 0) {
+					refinedRow[x] = -1.0f;
+					continue;
+				}
+
+				int best = 0;
+				for (int c = 1; c < candidates; ++c) {
+					if (costRows[c][x] < costRows[best][x]) best = c;
+				}
+
+				float subPixel = 0.0f;
+				if (best > 0 && best < candidates - 1) {
+					const float before = costRows[best - 1][x];
+					const float at = costRows[best][x];
+					const float after = costRows[best + 1][x];
+					const float denominator = before - 2.0f * at + after;
+					if (denominator > 0.0f) {
+						subPixel = 0.5f * (before - after) / denominator;
+					}
+				}
+
+				const float d = baseRow[x] + (best - radius) + subPixel;
+				// Outside the search range, or matched against pixels left of the right image
+				refinedRow[x] = (d < 0.0f || d >= numDisparities || x - d < 0.0f) ? -1.0f : d;
+			}
+		}
+	});
+}
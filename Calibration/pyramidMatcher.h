@@ -0,0 +1,37 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+struct PyramidMatcherOptions {
+	int levels = 2;            // Refinement levels above the coarse one (2: quarter -> half -> full)
+	int numDisparities = 256;  // Disparity range at the finest level; the coarse level searches it scaled down
+	int blockSize = 21;        // StereoBM block size at the coarse level (odd)
+	int refineBlockSize = 9;   // SAD window at the refinement levels (odd)
+	int searchRadius = 2;      // Disparities searched either side of the upsampled estimate
+};
+
+/* Coarse-to-fine disparity search.
+ * StereoBM runs over the full disparity range only at the coarsest pyramid level. Each finer
+ * level doubles the estimate from the level below and searches just
+ * [2d - searchRadius, 2d + searchRadius] around it, so the per-pixel work no longer grows with
+ * the disparity range. Pixels without a coarse estimate stay invalid.
+ *
+ * compute() keeps no state between calls and may run concurrently.
+ */
+class PyramidStereoMatcher {
+public:
+	explicit PyramidStereoMatcher(const PyramidMatcherOptions& options = PyramidMatcherOptions());
+
+	// left/right: rectified 8-bit grayscale at the finest resolution. disparity: CV_16S with
+	// 4 fractional bits and -16 for invalid pixels, the same encoding as StereoBM.
+	void compute(const cv::Mat& left, const cv::Mat& right, cv::Mat& disparity) const;
+
+	const PyramidMatcherOptions& options() const { return options_; }
+
+private:
+	// Band limited search around prior (CV_32F, pixels, < 0 where invalid) at one level
+	void refineLevel(const cv::Mat& left, const cv::Mat& right, const cv::Mat& prior,
+		int numDisparities, cv::Mat& refined) const;
+
+	PyramidMatcherOptions options_;
+};
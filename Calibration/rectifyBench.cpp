@@ -0,0 +1,102 @@
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include "stereoRectifier.h"
+#include "lazyRectifiedImage.h"
+#include "benchTiming.h"
+
+/* Cost of lazy, tile based rectification against rectifying whole frames.
+ * First checks that the lazy views match StereoRectifier::rectify() pixel for pixel, both for a
+ * region read from a partially filled frame and for the full frame. Then rectifies the pair with
+ * StereoRectifier::rectify(), and reads a centred region of interest, the full frame and a
+ * quarter size preview through LazyRectifiedImage views (a fresh frame each iteration), reporting
+ * the median time and how many tiles each access computed.
+ */
+
+// True if the lazy view of image matches the whole frame remap, for a region and the full frame
+static bool lazyMatchesRectify(LazyRectifiedImage& lazy, const cv::Mat& image, const cv::Mat& rectified,
+	const cv::Rect& roi) {
+	lazy.reset(image);
+	const cv::Mat region = lazy.roi(roi);
+	const cv::Rect clipped = roi & cv::Rect(cv::Point(0, 0), rectified.size());
+	if (region.size() != clipped.size() || cv::norm(region, rectified(clipped), cv::NORM_INF) != 0) {
+		return false;
+	}
+
+	const cv::Mat full = lazy.full();
+	return full.size() == rectified.size() && cv::norm(full, rectified, cv::NORM_INF) == 0;
+}
+
+int main(int argc, char* argv[]) {
+	// Command line parameters
+	// RectifyBench <image1> <image2> <calibration> [iterations] [roi-size]
+	if (argc < 4) {
+		std::cerr << "Usage: RectifyBench <image1> <image2> <calibration> [iterations] [roi-size]\n";
+		return -1;
+	}
+	cv::Mat image1 = cv::imread(argv[1]);
+	cv::Mat image2 = cv::imread(argv[2]);
+	if (image1.empty() || image2.empty()) {
+		std::cerr << "Error: Could not load one or both images.\n";
+		return -1;
+	}
+	const int iterations = argc > 4 ? std::max(1, std::stoi(argv[4])) : 10;
+	const int roiSize = argc > 5 ? std::max(1, std::stoi(argv[5])) : 256;
+
+	const StereoRectifier rectifier = StereoRectifier::fromFile(argv[3], image1.size());
+	const cv::Size outputSize = rectifier.outputSize();
+	const cv::Rect roi((outputSize.width - roiSize) / 2, (outputSize.height - roiSize) / 2, roiSize, roiSize);
+
+	LazyRectifiedImage lazyLeft(rectifier, StereoCamera::Left);
+	LazyRectifiedImage lazyRight(rectifier, StereoCamera::Right);
+	const int totalTiles = 2 * lazyLeft.tileGrid().area();
+
+	// --- Tile by tile remapping must reproduce the whole frame remap exactly ---
+	cv::Mat rectifiedL, rectifiedR;
+	rectifier.rectify(image1, image2, rectifiedL, rectifiedR);
+	if (!lazyMatchesRectify(lazyLeft, image1, rectifiedL, roi) || !lazyMatchesRectify(lazyRight, image2, rectifiedR, roi)) {
+		std::cerr << "Error: Lazy rectification differs from StereoRectifier::rectify()\n";
+		return -1;
+	}
+	std::cout << "Lazy rectification matches StereoRectifier::rectify() exactly\n\n";
+
+	BenchTable table(std::cout, { { "Access (both cameras)", 28 }, { "Time(ms)", 11 }, { "Tiles", 14 } });
+
+	// --- Whole frames, the current path ---
+	const double eagerMs = medianMs([&]() { rectifier.rectify(image1, image2, rectifiedL, rectifiedR); }, iterations);
+	table.cell("StereoRectifier::rectify").cell(eagerMs).endRow();
+
+	// --- Lazy views, each iteration starts a new frame ---
+	auto lazyRun = [&](const std::string& name, const std::function<void()>& access) {
+		const double ms = medianMs([&]() {
+			lazyLeft.reset(image1);
+			lazyRight.reset(image2);
+			access();
+		}, iterations);
+		const int tiles = lazyLeft.computedTiles() + lazyRight.computedTiles();
+		table.cell(name).cell(ms).cell(std::to_string(tiles) + " / " + std::to_string(totalTiles)).endRow();
+	};
+
+	lazyRun("roi " + std::to_string(roiSize) + "x" + std::to_string(roiSize), [&]() {
+		lazyLeft.roi(roi);
+		lazyRight.roi(roi);
+	});
+	lazyRun("full", [&]() {
+		lazyLeft.full();
+		lazyRight.full();
+	});
+	lazyRun("preview 0.25", [&]() {
+		lazyLeft.preview(0.25);
+		lazyRight.preview(0.25);
+	});
+	lazyRun("roi, then full (shared)", [&]() {
+		lazyLeft.roi(roi);
+		lazyRight.roi(roi);
+		lazyLeft.full();
+		lazyRight.full();
+	});
+
+	return 0;
+}
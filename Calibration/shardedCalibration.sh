@@ -0,0 +1,61 @@
+#!/bin/sh
+# Runs sharded corner detection as N local processes, merges the shards and calibrates, then
+# repeats the run as a single shard and checks that both give the same calibration.
+# Run from the Calibration directory so data/ is found. The merges run in a scratch directory,
+# so the calibration files already in the Calibration directory are left alone.
+#
+# Usage: ./shardedCalibration.sh <path to Calibration binary> [N]
+set -e
+
+CALIBRATION=${1:?usage: $0 <path to Calibration binary> [N]}
+SHARDS=${2:-4}
+case "$CALIBRATION" in
+	/*) ;;
+	*/*) CALIBRATION="$PWD/$CALIBRATION" ;; # Still valid after changing into the scratch directory
+esac
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+run() {
+	count=$1
+	pids=""
+	i=0
+	while [ "$i" -lt "$count" ]; do
+		"$CALIBRATION" detect --shard "$i/$count" --out "$WORK/corners_${count}_$i.yml" > "$WORK/detect_${count}_$i.log" 2>&1 &
+		pids="$pids $!"
+		i=$((i + 1))
+	done
+
+	# Wait for every shard so none is left running, then report the ones that failed
+	failed=0
+	i=0
+	for pid in $pids; do
+		if ! wait "$pid"; then
+			echo "Shard $i/$count failed, log:" >&2
+			cat "$WORK/detect_${count}_$i.log" >&2
+			failed=1
+		fi
+		i=$((i + 1))
+	done
+	if [ "$failed" -ne 0 ]; then
+		exit 1
+	fi
+
+	# merge writes its YAML files to the current directory
+	mkdir "$WORK/merge_$count"
+	(cd "$WORK/merge_$count" && "$CALIBRATION" merge "$WORK"/corners_${count}_*.yml) > "$WORK/merge_$count.log"
+	cp "$WORK/merge_$count/stereo_camera_calibration.yml" "$WORK/stereo_$count.yml"
+	grep "Reprojection Error" "$WORK/merge_$count.log"
+}
+
+echo "=== $SHARDS shards ==="
+run "$SHARDS"
+echo "=== 1 shard ==="
+run 1
+
+if cmp -s "$WORK/stereo_$SHARDS.yml" "$WORK/stereo_1.yml"; then
+	echo "Calibration identical for $SHARDS shards and 1 shard"
+else
+	echo "Calibration differs between $SHARDS shards and 1 shard"
+	exit 1
+fi
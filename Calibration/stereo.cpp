@@ -1,5 +1,11 @@
 #include <opencv2/opencv.hpp>
 #include "calibrationIO.h"
+#include "stereoRectifier.h"
+#include "pyramidMatcher.h"
+#include <memory>
+#ifdef HAVE_FRAME_RING
+#include "frameRing.h"
+#endif
 
 /* Create a method that will filter through the bell image pair,
  * through different levels of block sizing and number of disparities.
@@ -9,15 +15,19 @@
  * the resulting images will be saved to the disk, with descriptive names.
 */
 int matcherValueTest() {
+	return 0;
 }
 
 
 int main(int argc, char* argv[]) {
 
 	const bool debugging = false;
+	// Coarse-to-fine matching at half resolution instead of single level StereoBM at quarter resolution
+	const bool hierarchicalDisparity = false;
 
 	// Command line parameters
-	// stereo <image1> <image2> <calibration>
+	// stereo <image1> <image2> <calibration> [shm-name]
+	// With shm-name, the rectified pair, disparity and Q are published to a shared memory ring
 
 	// Read in the two images
 	cv::Mat image1 = cv::imread(argv[1]);
@@ -35,45 +45,19 @@ int main(int argc, char* argv[]) {
 	std::cout << "R" << std::endl << R << std::endl;
 	std::cout << "t" << std::endl << t << std::endl;
 
-	// Rectify the images
-	/*
-	* R1  a transformation (rotation matrix) that moves 3D points from the original to rectified camera spaces for camera 1.
-	* R2  a transformation (rotation matrix) that moves 3D points from the original to rectified camera spaces for camera 2.
-	* P1  the projection matrix for the (virtual) camera view that would produce the first rectified image.
-	* P2  the projection matrix for the (virtual) camera view that would produce the second rectified image.
-	* Q  the 3D transformation that converts an image point and associated disparity into a 3D point.
-	*/
-	cv::Mat R1, R2, P1, P2, Q;
-	cv::stereoRectify(
-		K1, d1, K2, d2,
-		image1.size(), R, t,
-		R1, R2, P1, P2, Q);
-
-	// Create the maps for remapping
-	cv::Mat UmapLeft, VmapLeft;
-	cv::Mat UmapRight, VmapRight;
-	int type = CV_32FC1; // Type of the map
-
-	// Create the maps for the images
-	cv::initUndistortRectifyMap(K1, d1, R1, P1, image1.size(), type, UmapLeft, VmapLeft);
-	cv::initUndistortRectifyMap(K2, d2, R2, P2, image1.size(), type, UmapRight, VmapRight);
-
-	// Remap the images
-	cv::Mat image1Rectified, image2Rectified;
-	cv::remap(image1, image1Rectified, UmapLeft, VmapLeft, cv::INTER_LINEAR);
-	cv::remap(image2, image2Rectified, UmapRight, VmapRight, cv::INTER_LINEAR);
-
-	// ===== Preprocess images =====
-	// Resize the images to a smaller size for faster processing
+	// Rectify the images straight to a reduced size for faster processing.
+	// The rectifier builds R1/R2, P1/P2, Q and the remap tables once; P1, P2 and Q are
+	// scaled to the reduced image size.
+	const double outputScale = hierarchicalDisparity ? 0.5 : 0.25;
+	const StereoRectifier rectifier(K1, d1, K2, d2, R, t, image1.size(), outputScale);
+
 	cv::Mat image1RS, image2RS;
-	cv::resize(image1Rectified, image1RS, cv::Size(), 0.25, 0.25);
-	cv::resize(image2Rectified, image2RS, cv::Size(), 0.25, 0.25);
+	rectifier.rectify(image1, image2, image1RS, image2RS);
 
 	if (debugging) {
-		std::cout << "Image 1 size before resize: " << std::endl << image1Rectified.size() << std::endl;
-		std::cout << "Image 2 size before resize: " << std::endl << image2Rectified.size() << std::endl;
-		std::cout << "Image 1 size after resize: " << std::endl << image1RS.size() << std::endl;
-		std::cout << "Image 2 size after resize: " << std::endl << image2RS.size() << std::endl;
+		std::cout << "Image size before rectification: " << std::endl << image1.size() << std::endl;
+		std::cout << "Rectified image size: " << std::endl << rectifier.outputSize() << std::endl;
+		std::cout << "Q" << std::endl << rectifier.Q() << std::endl;
 	}
 
 	// Convert the images to grayscale
@@ -82,14 +66,41 @@ int main(int argc, char* argv[]) {
 	cv::cvtColor(image2RS, grayRight, cv::COLOR_BGR2GRAY);
 
 	// ===== Block Matching ======
-	// Create StereoBM object
-	int maxDisparity = 64; // Must be divisible by 16
+	int maxDisparity = 64; // Must be divisible by 16, at quarter resolution
 	int blockSize = 21; // Must be odd
-	cv::Ptr<cv::StereoBM> blockMatcher = cv::StereoBM::create(maxDisparity, blockSize);
-
-	// Compute disparity map
 	cv::Mat disparityBM;
-	blockMatcher->compute(grayLeft, grayRight, disparityBM);
+
+	if (hierarchicalDisparity) {
+		// Full range search at quarter resolution, then a narrow band at half resolution
+		PyramidMatcherOptions options;
+		options.levels = 1;
+		options.numDisparities = 2 * maxDisparity;
+		options.blockSize = blockSize;
+		PyramidStereoMatcher pyramidMatcher(options);
+		pyramidMatcher.compute(grayLeft, grayRight, disparityBM);
+	}
+	else {
+		// Create StereoBM object
+		cv::Ptr<cv::StereoBM> blockMatcher = cv::StereoBM::create(maxDisparity, blockSize);
+
+		// Compute disparity map
+		blockMatcher->compute(grayLeft, grayRight, disparityBM);
+	}
+
+	// Publish for other processes on this host, kept alive until the windows are closed
+#ifdef HAVE_FRAME_RING
+	std::unique_ptr<FrameRingPublisher> publisher;
+#endif
+	if (argc > 4) {
+#ifdef HAVE_FRAME_RING
+		publisher.reset(new FrameRingPublisher(argv[4], 4,
+			image1RS.size(), image1RS.type(), disparityBM.size(), disparityBM.type()));
+		uint64_t sequence = publisher->publish(image1RS, image2RS, disparityBM, rectifier.Q());
+		std::cout << "Published frame " << sequence << " to " << publisher->name() << std::endl;
+#else
+		std::cerr << "Frame publishing to " << argv[4] << " is not available on this platform" << std::endl;
+#endif
+	}
 
 	// Display the images
 	cv::namedWindow("Left", cv::WINDOW_NORMAL);
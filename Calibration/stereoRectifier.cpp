@@ -0,0 +1,118 @@
+#include "stereoRectifier.h"
+#include "calibrationIO.h"
+
+static cv::Rect scaleRect(const cv::Rect& rect, double scale) {
+	cv::Point topLeft(cvCeil(rect.x * scale), cvCeil(rect.y * scale));
+	cv::Point bottomRight(cvFloor((rect.x + rect.width) * scale), cvFloor((rect.y + rect.height) * scale));
+	return cv::Rect(topLeft, bottomRight);
+}
+
+StereoRectifier::StereoRectifier(const cv::Mat& K1, const cv::Mat& distCoeff1,
+	const cv::Mat& K2, const cv::Mat& distCoeff2,
+	const cv::Mat& R, const cv::Mat& t,
+	const cv::Size& imageSize,
+	double outputScale,
+	double alpha,
+	int interpolation)
+	: imageSize_(imageSize),
+	outputScale_(outputScale),
+	interpolation_(interpolation) {
+
+	CV_Assert(outputScale > 0.0);
+	outputSize_ = cv::Size(cvRound(imageSize.width * outputScale), cvRound(imageSize.height * outputScale));
+
+	// --- Stereo Rectify at the calibrated image size ---
+	cv::Rect roiLeft, roiRight;
+	cv::stereoRectify(
+		K1, distCoeff1, K2, distCoeff2,
+		imageSize, R, t,
+		R1_, R2_, P1_, P2_, Q_,
+		cv::CALIB_ZERO_DISPARITY, alpha, imageSize, &roiLeft, &roiRight);
+
+	// --- Scale the projection matrices to the output size ---
+	// Scaling the first two rows of P rescales the rectified pixel grid. Q maps (u, v, d, 1)
+	// to homogeneous 3D points; with u, v and d all scaled, scaling its last column gives the
+	// same points.
+	if (outputScale != 1.0) {
+		cv::Mat P1Rows = P1_.rowRange(0, 2);
+		cv::Mat P2Rows = P2_.rowRange(0, 2);
+		cv::Mat QLastCol = Q_.col(3);
+		P1Rows *= outputScale;
+		P2Rows *= outputScale;
+		QLastCol *= outputScale;
+		validRoiLeft_ = scaleRect(roiLeft, outputScale);
+		validRoiRight_ = scaleRect(roiRight, outputScale);
+	}
+	else {
+		validRoiLeft_ = roiLeft;
+		validRoiRight_ = roiRight;
+	}
+
+	// --- Create Rectification Maps, directly at the output size ---
+	cv::initUndistortRectifyMap(K1, distCoeff1, R1_, P1_, outputSize_, CV_16SC2, mapLeft1_, mapLeft2_);
+	cv::initUndistortRectifyMap(K2, distCoeff2, R2_, P2_, outputSize_, CV_16SC2, mapRight1_, mapRight2_);
+}
+
+StereoRectifier StereoRectifier::fromFile(const std::string& filename,
+	const cv::Size& imageSize,
+	double outputScale,
+	double alpha,
+	int interpolation) {
+
+	cv::Mat K1, d1, K2, d2, R, t;
+	readStereoCalibration(filename, K1, d1, K2, d2, R, t);
+	if (K1.empty() || K2.empty() || R.empty() || t.empty()) {
+		CV_Error(cv::Error::StsBadArg, "Could not read stereo calibration from " + filename);
+	}
+
+	return StereoRectifier(K1, d1, K2, d2, R, t, imageSize, outputScale, alpha, interpolation);
+}
+
+void StereoRectifier::rectify(const cv::Mat& left, const cv::Mat& right,
+	cv::Mat& rectifiedLeft, cv::Mat& rectifiedRight) const {
+
+	CV_Assert(left.size() == imageSize_ && right.size() == imageSize_);
+
+	cv::remap(left, rectifiedLeft, mapLeft1_, mapLeft2_, interpolation_);
+	cv::remap(right, rectifiedRight, mapRight1_, mapRight2_, interpolation_);
+}
+
+void StereoRectifier::rectify(const std::vector<StereoPair>& pairs, std::vector<StereoPair>& outputs) const {
+	CV_Assert(outputs.size() == pairs.size());
+
+	cv::parallel_for_(cv::Range(0, static_cast<int>(pairs.size())), [&](const cv::Range& range) {
+		for (int i = range.start; i < range.end; ++i) {
+			rectify(pairs[i].left, pairs[i].right, outputs[i].left, outputs[i].right);
+		}
+	});
+}
+
+void StereoRectifier::rectifyRegion(const cv::Mat& image, StereoCamera camera, const cv::Rect& region,
+	cv::Mat& destination) const {
+
+	CV_Assert(image.size() == imageSize_);
+	CV_Assert((region & cv::Rect(cv::Point(0, 0), outputSize_)) == region);
+
+	const bool left = camera == StereoCamera::Left;
+	const cv::Mat& map1 = left ? mapLeft1_ : mapRight1_;
+	const cv::Mat& map2 = left ? mapLeft2_ : mapRight2_;
+	cv::remap(image, destination, map1(region), map2(region), interpolation_);
+}
+
+void StereoRectifier::previewMaps(StereoCamera camera, const cv::Size& previewSize, const cv::Size& sourceSize,
+	cv::Mat& mapX, cv::Mat& mapY) const {
+
+	const bool left = camera == StereoCamera::Left;
+
+	// Float tables at the output size, then resampled at the preview pixel centres
+	cv::Mat fullX, fullY;
+	cv::convertMaps(left ? mapLeft1_ : mapRight1_, left ? mapLeft2_ : mapRight2_, fullX, fullY, CV_32FC1);
+	cv::resize(fullX, mapX, previewSize, 0, 0, cv::INTER_LINEAR);
+	cv::resize(fullY, mapY, previewSize, 0, 0, cv::INTER_LINEAR);
+
+	// Input pixel coordinates to the downscaled copy's pixel coordinates
+	const double scaleX = static_cast<double>(sourceSize.width) / imageSize_.width;
+	const double scaleY = static_cast<double>(sourceSize.height) / imageSize_.height;
+	mapX.convertTo(mapX, CV_32F, scaleX, 0.5 * scaleX - 0.5);
+	mapY.convertTo(mapY, CV_32F, scaleY, 0.5 * scaleY - 0.5);
+}
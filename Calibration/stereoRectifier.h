@@ -0,0 +1,93 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+enum class StereoCamera {
+	Left,
+	Right
+};
+
+// A left/right image pair, used for both rectifier input and output
+struct StereoPair {
+	cv::Mat left;
+	cv::Mat right;
+};
+
+/* Rectification state for a calibrated stereo rig.
+ * Everything (rectification transforms, projection matrices and remap tables) is computed once
+ * in the constructor and never changes afterwards, so a single instance can be shared between
+ * threads and all rectify() calls are safe to run concurrently.
+ *
+ * outputScale lets the rectified images be produced directly at a reduced size (e.g. 0.25),
+ * instead of remapping at full resolution and resizing afterwards. P1, P2 and Q are scaled to
+ * match the output images.
+ */
+class StereoRectifier {
+public:
+	StereoRectifier(const cv::Mat& K1, const cv::Mat& distCoeff1,
+		const cv::Mat& K2, const cv::Mat& distCoeff2,
+		const cv::Mat& R, const cv::Mat& t,
+		const cv::Size& imageSize,
+		double outputScale = 1.0,
+		double alpha = -1.0,
+		int interpolation = cv::INTER_LINEAR);
+
+	// Builds a rectifier from a file written by saveStereoCalibration()
+	static StereoRectifier fromFile(const std::string& filename,
+		const cv::Size& imageSize,
+		double outputScale = 1.0,
+		double alpha = -1.0,
+		int interpolation = cv::INTER_LINEAR);
+
+	// Rectifies a single pair. Output Mats that already have the right size and type are reused.
+	void rectify(const cv::Mat& left, const cv::Mat& right,
+		cv::Mat& rectifiedLeft, cv::Mat& rectifiedRight) const;
+
+	// Rectifies a batch of pairs in parallel. outputs must be the same length as pairs;
+	// the caller owns the buffers, so keeping outputs alive between calls avoids reallocation.
+	void rectify(const std::vector<StereoPair>& pairs, std::vector<StereoPair>& outputs) const;
+
+	// Rectifies only region (in output coordinates) of one camera's image. destination may be a
+	// view into a larger buffer; if it already has the region's size and type it is written in place.
+	void rectifyRegion(const cv::Mat& image, StereoCamera camera, const cv::Rect& region, cv::Mat& destination) const;
+
+	// Float remap tables (CV_32FC1) for a previewSize rectified image, read from a copy of the
+	// input downscaled to sourceSize with INTER_AREA. Downscaling the input first low-pass filters
+	// it, and only the preview pixels are remapped.
+	void previewMaps(StereoCamera camera, const cv::Size& previewSize, const cv::Size& sourceSize,
+		cv::Mat& mapX, cv::Mat& mapY) const;
+
+	int interpolation() const { return interpolation_; }
+
+	const cv::Size& imageSize() const { return imageSize_; }
+	const cv::Size& outputSize() const { return outputSize_; }
+	double outputScale() const { return outputScale_; }
+
+	// R1/R2 - rotations from the original to the rectified camera spaces.
+	// P1/P2 - projection matrices of the rectified (virtual) cameras, in output pixels.
+	// Q - converts an output image point and its disparity into a 3D point.
+	const cv::Mat& R1() const { return R1_; }
+	const cv::Mat& R2() const { return R2_; }
+	const cv::Mat& P1() const { return P1_; }
+	const cv::Mat& P2() const { return P2_; }
+	const cv::Mat& Q() const { return Q_; }
+
+	// Valid pixel regions in output image coordinates
+	const cv::Rect& validRoiLeft() const { return validRoiLeft_; }
+	const cv::Rect& validRoiRight() const { return validRoiRight_; }
+
+private:
+	cv::Size imageSize_;
+	cv::Size outputSize_;
+	double outputScale_;
+	int interpolation_;
+
+	cv::Mat R1_, R2_, P1_, P2_, Q_;
+	cv::Rect validRoiLeft_, validRoiRight_;
+
+	// Fixed point remap tables (CV_16SC2 + CV_16UC1), faster to apply than float maps
+	cv::Mat mapLeft1_, mapLeft2_;
+	cv::Mat mapRight1_, mapRight2_;
+};